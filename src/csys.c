@@ -34,12 +34,11 @@
  * Lines are 78 columns.
  ****************************************************************************/
 
-/* There will be at least 3 modules:
- *   sys/nix      - all posixy stuff
- *   sys/windows/ - all win32
- *   sys/         - likely all in Janet, wrapping the necessary functions from
- *                - other sys submodules in an interface to work across
- *                - systems (or raise error for "not supported on this OS") */
+/* Which system's implementation of each function gets built is settled at
+ * compile time, every function is registered under the same name on every
+ * system (raising "not implemented for this system" where unsupported), and
+ * sys.janet re-exports them. Anything friendlier that's best written in
+ * Janet lives there. */
 
 /*============================================================================
  * Includes                                                                  *
@@ -52,16 +51,38 @@
 #include <unistd.h>    /* chown(2) chroot(2) dup2(2) fork(2)
                         * setegid(2) seteuid(2) setgid(2)
                         * setuid(2) setsid(2) getpid(2) getppid(2) */
-#include <fcntl.h>     /* F_GETLK F_SETLK - fcntl(2) open(2) */
+#include <fcntl.h>     /* F_GETLK F_SETLK - fcntl(2) open(2) fallocate(2)
+                        * posix_fallocate(3) posix_fadvise(2)
+                        * sync_file_range(2) */
 #include <pwd.h>       /* struct passwd - getpwnam_r(3) */
 #include <grp.h>       /* struct group - getgrnam(3) */
 #include <stdio.h>     /* fileno(3) */
+#include <stdlib.h>    /* strtod(3) */
+#include <dirent.h>    /* opendir(3) readdir(3) */
+#include <sys/resource.h> /* struct rusage struct rlimit - getrusage(2)
+                           * getrlimit(2) setrlimit(2) prlimit(2) */
+#include <sched.h>     /* sched_setscheduler(2) */
+#include <sys/mman.h>  /* mmap(2) munmap(2) mremap(2) memfd_create(2)
+                        * shm_open(3) shm_unlink(3) */
+#include <sys/stat.h>  /* fstat(2) fstatat(2) statx(2) */
+#include <signal.h>    /* SIGTERM SIGKILL ... */
+#include <sys/wait.h>  /* siginfo_t P_PIDFD WEXITED - waitid(2) */
+#include <pthread.h>   /* pthread_create(3) */
+#include <sys/socket.h> /* socketpair(2) send(2) */
+#ifdef __linux__
+#include <sys/fsuid.h>   /* setfsuid(2) setfsgid(2) */
+#include <sys/syscall.h> /* SYS_setgroups SYS_ioprio_set SYS_ioprio_get
+                          * SYS_pidfd_open SYS_pidfd_send_signal
+                          * SYS_waitid SYS_futex SYS_getdents64
+                          * - syscall(2) */
+#include <linux/futex.h> /* FUTEX_WAIT FUTEX_WAKE */
+#endif
 #else
 #include <Windows.h>
 #include <processthreadsapi.h> /* GetCurrentProcessID:getpid(2) */
 #endif
 
-#include <time.h>      /* strftime(3)  */
+#include <time.h>      /* strftime(3) clock_gettime(2) */
 #include <janet.h>
 
 /*============================================================================
@@ -85,17 +106,20 @@
     janet_panicf(error ", error: %s", __VA_ARGS__, strerror(errno))
 #define sys_errno(error) janet_panicf(error ", error: %s", strerror(errno))
 
-#ifndef JANET_WINDOWS
-#define SYS_IMPL "nix"
-#else
-#define SYS_IMPL "windows"
+/* Call statistics (sys/stats) rely on GCC style atomic builtins, define
+ * SYS_NO_STATS to compile them out entirely. */
+#if !defined(SYS_NO_STATS) && !defined(__GNUC__)
+#define SYS_NO_STATS
 #endif
+#define SYS_STATS_MAX    200 /* most cfuns that can be instrumented */
+#define SYS_STATS_BUCKETS 64 /* log2 latency buckets, in nanoseconds */
 
-#define SYS_UNAME(name) "sys/" SYS_IMPL "/" name
+#define SYS_UNAME(name) "sys/" name
 #define SYS_FUSAGE0(name) "(" SYS_UNAME(name) ")"
 #define SYS_FUSAGE(name, rest) "(" SYS_UNAME(name) rest ")"
 /* Definition for:
- *   GLIBC_PREREQ, HAVE_DUP3 __NetBSD_Prereq__, NETBSD_PREREQ, FREEBSD_PREREQ
+ *   GLIBC_PREREQ, HAVE_DUP3 HAVE_PIPE2 __NetBSD_Prereq__, NETBSD_PREREQ,
+ *   FREEBSD_PREREQ
  *   U_CLOEXEC, U_SYSFLAGS, U_FIXFLAGS, U_FDFLAGS, U_FLFLAGS,
  *   GETGRGID_R_NETBSD, U_GETPWUID_R_NETBSD, GETPWNAM_R_NETBSD
  *   GETGRNAM_R_NETBSD
@@ -144,6 +168,12 @@
      || UCLIBC_PREREQ(0,9,34))
 #endif
 
+#ifndef HAVE_PIPE2
+#define HAVE_PIPE2                                                      \
+    (GLIBC_PREREQ(2,9) || FREEBSD_PREREQ(10,0) || NETBSD_PREREQ(6,0)    \
+     || UCLIBC_PREREQ(0,9,32))
+#endif
+
 #ifndef O_CLOEXEC
 #define U_CLOEXEC (1LL << 32)
 #else
@@ -161,19 +191,52 @@
 /* *nix: unistd.h, *: ? */
 JANET_CFUN(cfun_chown);
 JANET_CFUN(cfun_chroot);
+/* *nix: fcntl.h dirent.h pthread.h sys/socket.h sys/stat.h (Linux only),
+ * *: ? */
+JANET_CFUN(cfun_chown_tree);
+JANET_CFUN(cfun_walk);
 JANET_CFUN(cfun_dup2);
 JANET_CFUN(cfun_fork);
+/* *nix: sys/wait.h sys/syscall.h (Linux only), *: ? */
+JANET_CFUN(cfun_pidfd_open);
+JANET_CFUN(cfun_pidfd_wait);
+JANET_CFUN(cfun_pidfd_send_signal);
 JANET_CFUN(cfun_setegid);
 JANET_CFUN(cfun_seteuid);
 JANET_CFUN(cfun_setgid);
 JANET_CFUN(cfun_setuid);
 JANET_CFUN(cfun_setsid);
+/* *nix: sys/fsuid.h sys/syscall.h (Linux only), *: ? */
+JANET_CFUN(cfun_setfsuid);
+JANET_CFUN(cfun_setfsgid);
+JANET_CFUN(cfun_setgroups);
+/* *nix: sys/resource.h, *: ? */
+JANET_CFUN(cfun_getrlimit);
+JANET_CFUN(cfun_setrlimit);
+JANET_CFUN(cfun_prlimit);
+JANET_CFUN(cfun_raise_rlimit);
 /* windows: GetCurrentProcessID | processthreadsapi.h/Windows.h? */
 JANET_CFUN(cfun_getpid);
 JANET_CFUN(cfun_getppid);
 
+/* *nix: sys/resource.h, /proc (Linux only), *: ? */
+JANET_CFUN(cfun_getrusage);
+JANET_CFUN(cfun_procstat);
+
+/* *nix: sched.h sys/resource.h, /sys (Linux only), *: ? */
+JANET_CFUN(cfun_sched_setaffinity);
+JANET_CFUN(cfun_sched_getaffinity);
+JANET_CFUN(cfun_sched_setscheduler);
+JANET_CFUN(cfun_sched_getscheduler);
+JANET_CFUN(cfun_setpriority);
+JANET_CFUN(cfun_getpriority);
+JANET_CFUN(cfun_ioprio_set);
+JANET_CFUN(cfun_ioprio_get);
+JANET_CFUN(cfun_cpu_topology);
+
 /* *nix: fcntl.h, *: ? */
 JANET_CFUN(cfun_fcntl);
+JANET_CFUN(cfun_pipe2);
 
 /* *nix: pwd.h, *: ? */
 JANET_CFUN(cfun_getpwnam);
@@ -185,9 +248,44 @@ JANET_CFUN(cfun_getgrnam);
 JANET_CFUN(cfun_file_handle);
 int file_to_fd(Janet *, int);
 
+/* *nix: fcntl.h unistd.h, *: ? */
+JANET_CFUN(cfun_fallocate);
+JANET_CFUN(cfun_fadvise);
+JANET_CFUN(cfun_fdatasync);
+JANET_CFUN(cfun_sync_file_range);
+
+/* *nix: sys/mman.h, *: ? */
+JANET_CFUN(cfun_memfd_create);
+JANET_CFUN(cfun_shm_open);
+JANET_CFUN(cfun_shm_unlink);
+JANET_CFUN(cfun_shm_map);
+JANET_CFUN(cfun_shm_resize);
+JANET_CFUN(cfun_shm_seal);
+JANET_CFUN(cfun_shm_view);
+JANET_CFUN(cfun_shm_read);
+JANET_CFUN(cfun_shm_write);
+JANET_CFUN(cfun_shm_close);
+
+/* *nix: GCC atomics, linux/futex.h (rings Linux only), *: ? */
+JANET_CFUN(cfun_atomic_load);
+JANET_CFUN(cfun_atomic_store);
+JANET_CFUN(cfun_atomic_add);
+JANET_CFUN(cfun_atomic_cas);
+JANET_CFUN(cfun_ring_bytes);
+JANET_CFUN(cfun_ring_init);
+JANET_CFUN(cfun_ring_open);
+JANET_CFUN(cfun_ring_push);
+JANET_CFUN(cfun_ring_pop);
+
 /* *nix: time.h *: ? */
 JANET_CFUN(cfun_strftime);
 
+/* *: instrumentation of the above */
+JANET_CFUN(cfun_stats);
+JANET_CFUN(cfun_stats_reset);
+JANET_CFUN(cfun_stats_enable);
+static void sys_stats_wrap(JanetRegExt *);
+
 /*============================================================================
  * Function definitions
  ===========================================================================*/
@@ -206,9 +304,9 @@ JANET_FN(cfun_chown, SYS_FUSAGE("chown", " uid gid path-or-file"),
     uid_t uid = janet_getinteger(argv, 0);
     gid_t gid = janet_getinteger(argv, 1);
 
-    if(janet_checktype(argv[0], JANET_ABSTRACT)) {
+    if(janet_checktype(argv[2], JANET_ABSTRACT)) {
         int fd;
-        if (-1 != (fd = file_to_fd(argv, 0))) {
+        if (-1 != (fd = file_to_fd(argv, 2))) {
             if (0 != fchown(fd, uid, gid)) {
                 sys_errno("Failed to chown with file handle");
                 return janet_wrap_boolean(0);
@@ -217,7 +315,7 @@ JANET_FN(cfun_chown, SYS_FUSAGE("chown", " uid gid path-or-file"),
             janet_panic("Invalid file handle");
         }
     } else {
-        const char *where = (char *)janet_getstring(argv, 0);
+        const char *where = (char *)janet_getstring(argv, 2);
         if (0 != chown(where, uid, gid)) {
             sys_errnof("Failed to chown with path: %s", where);
             return janet_wrap_boolean(0);
@@ -415,6 +513,259 @@ JANET_FN(cfun_fork, SYS_FUSAGE0("fork"),
     return janet_wrap_integer(pid);
 }
 
+/* *nix: sys/wait.h sys/syscall.h, *: ? */
+#if defined(__linux__) && defined(SYS_pidfd_open) && defined(JANET_EV)
+#ifndef P_PIDFD
+#define P_PIDFD 3
+#endif
+
+static void sys_rusage_to_table(struct rusage *, JanetTable *);
+
+static const struct {
+    const char *name;
+    int         signal;
+} sys_signals[] = {
+    { "hup", SIGHUP }, { "int", SIGINT }, { "quit", SIGQUIT },
+    { "kill", SIGKILL }, { "term", SIGTERM }, { "usr1", SIGUSR1 },
+    { "usr2", SIGUSR2 }, { "stop", SIGSTOP }, { "cont", SIGCONT },
+    { NULL, 0 }
+};
+
+static const JanetMethod sys_pidfd_methods[] = {
+    { "close", janet_cfun_stream_close },
+    { "wait", cfun_pidfd_wait },
+    { "signal", cfun_pidfd_send_signal },
+    { NULL, NULL }
+};
+
+/* Status and resource usage of a reaped child, as returned by pidfd-wait */
+static Janet sys_pidfd_status(siginfo_t *info, struct rusage *ru) {
+    JanetTable *usage = janet_table(9);
+    sys_rusage_to_table(ru, usage);
+
+    int exited = CLD_EXITED == info->si_code;
+    JanetKV *ret = janet_struct_begin(5);
+    janet_struct_put(ret, janet_ckeywordv("pid"),
+                     janet_wrap_integer(info->si_pid));
+    janet_struct_put(ret, janet_ckeywordv("exit-code"),
+                     exited ? janet_wrap_integer(info->si_status)
+                            : janet_wrap_nil());
+    janet_struct_put(ret, janet_ckeywordv("signal"),
+                     exited ? janet_wrap_nil()
+                            : janet_wrap_integer(info->si_status));
+    janet_struct_put(ret, janet_ckeywordv("core-dumped"),
+                     janet_wrap_boolean(CLD_DUMPED == info->si_code));
+    janet_struct_put(ret, janet_ckeywordv("rusage"),
+                     janet_wrap_table(usage));
+
+    return janet_wrap_struct(janet_struct_end(ret));
+}
+
+/* Reaps the child behind `fd` if it has exited, returning 1 and putting its
+ * status and resource usage in `out`, 0 while it runs and -1 on error. The
+ * raw waitid(2) syscall is used as only it hands back the rusage. */
+static int sys_pidfd_reap(int fd, Janet *out) {
+    siginfo_t info = { 0 };
+    struct rusage ru;
+
+    if (-1 == syscall(SYS_waitid, P_PIDFD, fd, &info, WEXITED | WNOHANG, &ru))
+        return -1;
+
+    if (0 == info.si_pid)
+        return 0;
+
+    *out = sys_pidfd_status(&info, &ru);
+    return 1;
+}
+
+/* A pidfd turns readable once its process exits. Janet's epoll listening
+ * is edge triggered, so an edge that finds nothing to reap won't be
+ * followed by another: the wait is then finished by a blocking waitid(2)
+ * on a thread of its own, on a duplicate of the pidfd so closing the
+ * original can't pull it from under the thread. */
+typedef struct {
+    int           fd;
+    int           err;
+    siginfo_t     info;
+    struct rusage ru;
+} SysPidfdWait;
+
+static JanetEVGenericMessage sys_pidfd_block(JanetEVGenericMessage msg) {
+    SysPidfdWait *wait = (SysPidfdWait *) msg.argp;
+    long rc;
+
+    while (-1 == (rc = syscall(SYS_waitid, P_PIDFD, wait->fd, &wait->info,
+                               WEXITED, &wait->ru))
+           && EINTR == errno)
+        ;;
+
+    wait->err = -1 == rc ? errno : 0;
+    close(wait->fd);
+
+    return msg;
+}
+
+static void sys_pidfd_blocked(JanetEVGenericMessage msg) {
+    SysPidfdWait *wait = (SysPidfdWait *) msg.argp;
+
+    if (janet_fiber_can_resume(msg.fiber)) {
+        if (wait->err)
+            janet_cancel(msg.fiber, janet_cstringv(strerror(wait->err)));
+        else
+            janet_schedule(msg.fiber,
+                           sys_pidfd_status(&wait->info, &wait->ru));
+    }
+
+    janet_free(wait);
+    janet_gcunroot(janet_wrap_fiber(msg.fiber));
+}
+
+/* Hands the wait of `fiber` on to a thread, see above */
+static void sys_pidfd_wait_thread(JanetFiber *fiber, int fd) {
+    JanetEVGenericMessage msg;
+    SysPidfdWait *wait = janet_malloc(sizeof(SysPidfdWait));
+
+    if (!wait) {
+        janet_cancel(fiber, janet_cstringv("Out of memory"));
+        return;
+    }
+
+    memset(wait, 0, sizeof(SysPidfdWait));
+    if (-1 == (wait->fd = fcntl(fd, F_DUPFD_CLOEXEC, 0))) {
+        janet_cancel(fiber, janet_cstringv(strerror(errno)));
+        janet_free(wait);
+        return;
+    }
+
+    memset(&msg, 0, sizeof(msg));
+    msg.argp = wait;
+    msg.fiber = fiber;
+    janet_gcroot(janet_wrap_fiber(fiber));
+    janet_ev_threaded_call(sys_pidfd_block, msg, sys_pidfd_blocked);
+}
+
+static void sys_pidfd_callback(JanetFiber *fiber, JanetAsyncEvent event) {
+    Janet ret;
+
+    switch (event) {
+    default:
+        break;
+    case JANET_ASYNC_EVENT_CLOSE:
+        janet_cancel(fiber, janet_cstringv("pidfd closed while waiting"));
+        janet_async_end(fiber);
+        break;
+    case JANET_ASYNC_EVENT_ERR:
+    case JANET_ASYNC_EVENT_HUP:
+    case JANET_ASYNC_EVENT_READ:
+        switch (sys_pidfd_reap(fiber->ev_stream->handle, &ret)) {
+        case 1:
+            janet_schedule(fiber, ret);
+            break;
+        case 0:
+            sys_pidfd_wait_thread(fiber, fiber->ev_stream->handle);
+            break;
+        default:
+            janet_cancel(fiber, janet_cstringv(strerror(errno)));
+            break;
+        }
+        janet_async_end(fiber);
+        break;
+    }
+}
+
+JANET_FN(cfun_pidfd_open, SYS_FUSAGE("pidfd-open", " pid"),
+         "-> _:core/stream pidfd|throws error_\n\n"
+         "\t`pid` **:number**\n\n"
+         "Opens a process file descriptor referring to process `pid`, such "
+         "as a child returned by `fork`. Unlike the pid, it can't come to "
+         "refer to another process once the child is gone, so signals sent "
+         "with `pidfd-send-signal` can't reach the wrong process. It "
+         "supports the methods `:wait`, `:signal` and `:close`. Linux only "
+         "(5.3 and later).") {
+    janet_fixarity(argc, 1);
+
+    pid_t pid = janet_getinteger(argv, 0);
+    int fd;
+
+    if (-1 == (fd = (int) syscall(SYS_pidfd_open, pid, 0))) {
+        sys_errnof("Failed to open pidfd for pid: %d", pid);
+        return janet_wrap_boolean(0);
+    }
+
+    (void) u_setflag(fd, U_CLOEXEC, 1);
+
+    return janet_wrap_abstract(
+        janet_stream(fd, JANET_STREAM_READABLE, sys_pidfd_methods));
+}
+
+JANET_FN(cfun_pidfd_wait, SYS_FUSAGE("pidfd-wait", " pidfd"),
+         "-> _:struct status|throws error_\n\n"
+         "\t`pidfd` **:core/stream** _from `pidfd-open`_\n\n"
+         "\t**status** {:pid `:number` :exit-code `:number|nil` "
+         ":signal `:number|nil` :core-dumped `:boolean` "
+         ":rusage `:table`}\n\n"
+         "Waits for the child behind `pidfd` to exit and reaps it, returning "
+         "its exit code (or the signal that killed it) and its resource "
+         "usage as with `getrusage`. Only the calling fiber is suspended, "
+         "the event loop carries on running others meanwhile. Linux only "
+         "(5.4 and later).") {
+    janet_fixarity(argc, 1);
+
+    JanetStream *stream = janet_getabstract(argv, 0, &janet_stream_type);
+    Janet ret;
+
+    if (stream->flags & JANET_STREAM_CLOSED)
+        janet_panic("Slot #1 must be an open pidfd");
+
+    switch (sys_pidfd_reap(stream->handle, &ret)) {
+    case 1:
+        return ret;
+    case -1:
+        sys_errno("Failed to wait on pidfd");
+        return janet_wrap_boolean(0);
+    }
+
+    janet_async_start(stream, JANET_ASYNC_LISTEN_READ, sys_pidfd_callback,
+                      NULL);
+    return janet_wrap_nil();
+}
+
+JANET_FN(cfun_pidfd_send_signal,
+         SYS_FUSAGE("pidfd-send-signal", " pidfd signal"),
+         "-> _true|throws error_\n\n"
+         "\t`pidfd`  **:core/stream** _from `pidfd-open`_\n\n"
+         "\t`signal` **:number|:keyword** _such as :term :kill :int :hup "
+         ":quit :usr1 :usr2 :stop :cont_\n\n"
+         "Sends `signal` to the process behind `pidfd`. Linux only (5.1 and "
+         "later).") {
+    janet_fixarity(argc, 2);
+
+    JanetStream *stream = janet_getabstract(argv, 0, &janet_stream_type);
+    int sig = -1;
+
+    if (janet_checktype(argv[1], JANET_KEYWORD)) {
+        for (int i = 0; sys_signals[i].name; i++)
+            if (janet_keyeq(argv[1], sys_signals[i].name))
+                sig = sys_signals[i].signal;
+        if (-1 == sig)
+            janet_panicf("Unknown signal: %v", argv[1]);
+    } else {
+        sig = janet_getinteger(argv, 1);
+    }
+
+    if (0 != syscall(SYS_pidfd_send_signal, stream->handle, sig, NULL, 0)) {
+        sys_errnof("Failed to send signal: %d", sig);
+        return janet_wrap_boolean(0);
+    }
+
+    return janet_wrap_boolean(1);
+}
+#else /* not Linux, or no pidfd support */
+DEF_NOT_IMPL(cfun_pidfd_open, "sys/pidfd-open");
+DEF_NOT_IMPL(cfun_pidfd_wait, "sys/pidfd-wait");
+DEF_NOT_IMPL(cfun_pidfd_send_signal, "sys/pidfd-send-signal");
+#endif
+
 JANET_FN(cfun_setegid, SYS_FUSAGE("setegid", " gid"),
          "-> _true|throws error_\n\n"
          "\t`gid` **:number**\n\n"
@@ -455,7 +806,7 @@ JANET_FN(cfun_setgid, SYS_FUSAGE("setgid", " gid"),
 
     gid_t gid = janet_getinteger(argv, 0);
 
-    if (0 != setegid(gid)) {
+    if (0 != setgid(gid)) {
         sys_errnof("Failed to set group id: %d", gid);
         return janet_wrap_boolean(0);
     }
@@ -471,7 +822,7 @@ JANET_FN(cfun_setuid, SYS_FUSAGE("setuid", " uid"),
 
     uid_t uid = janet_getinteger(argv, 0);
 
-    if (0 != seteuid(uid)) {
+    if (0 != setuid(uid)) {
         sys_errnof("Failed to set user id: %d", uid);
         return janet_wrap_boolean(0);
     }
@@ -479,6 +830,333 @@ JANET_FN(cfun_setuid, SYS_FUSAGE("setuid", " uid"),
     return janet_wrap_boolean(1);
 }
 
+#ifdef __linux__
+/* setfsuid(2) and setfsgid(2) never report failure, they return the previous
+ * id whether the change happened or not. Ask again with an invalid id, which
+ * changes nothing, and compare to find out if the change took. */
+JANET_FN(cfun_setfsuid, SYS_FUSAGE("setfsuid", " uid"),
+         "-> _:number previous-uid|throws error_\n\n"
+         "\t`uid` **:number**\n\n"
+         "Sets the user id used for filesystem access checks by the calling "
+         "thread only to `uid`, returning the previous filesystem user id. "
+         "Other threads, and the real/effective ids of the process, are left "
+         "alone. Linux only.") {
+    janet_fixarity(argc, 1);
+
+    uid_t uid = janet_getinteger(argv, 0);
+    uid_t old = setfsuid(uid);
+
+    if (uid != (uid_t) setfsuid(-1)) {
+        errno = EPERM;
+        sys_errnof("Failed to set filesystem user id: %d", uid);
+        return janet_wrap_boolean(0);
+    }
+
+    return janet_wrap_integer(old);
+}
+
+JANET_FN(cfun_setfsgid, SYS_FUSAGE("setfsgid", " gid"),
+         "-> _:number previous-gid|throws error_\n\n"
+         "\t`gid` **:number**\n\n"
+         "Sets the group id used for filesystem access checks by the calling "
+         "thread only to `gid`, returning the previous filesystem group id. "
+         "Linux only.") {
+    janet_fixarity(argc, 1);
+
+    gid_t gid = janet_getinteger(argv, 0);
+    gid_t old = setfsgid(gid);
+
+    if (gid != (gid_t) setfsgid(-1)) {
+        errno = EPERM;
+        sys_errnof("Failed to set filesystem group id: %d", gid);
+        return janet_wrap_boolean(0);
+    }
+
+    return janet_wrap_integer(old);
+}
+
+/* glibc's setgroups(3) broadcasts the change to every thread of the process,
+ * the raw syscall only touches the calling thread. */
+#ifdef SYS_setgroups32
+#define SYS_SETGROUPS SYS_setgroups32
+#else
+#define SYS_SETGROUPS SYS_setgroups
+#endif
+
+JANET_FN(cfun_setgroups, SYS_FUSAGE("setgroups", " gids"),
+         "-> _:tuple previous-gids|throws error_\n\n"
+         "\t`gids` **:array|:tuple** _of :number_\n\n"
+         "Sets the supplementary group list of the calling thread only to "
+         "`gids`, returning the previous list. Linux only.") {
+    janet_fixarity(argc, 1);
+
+    JanetView gids = janet_getindexed(argv, 0);
+    int count;
+
+    if (-1 == (count = getgroups(0, NULL))) {
+        sys_errno("Failed to get supplementary groups");
+        return janet_wrap_boolean(0);
+    }
+
+    gid_t *old = janet_smalloc(sizeof(gid_t) * (count + 1));
+    gid_t *new = janet_smalloc(sizeof(gid_t) * (gids.len + 1));
+
+    if (-1 == (count = getgroups(count, old))) {
+        janet_sfree(old);
+        janet_sfree(new);
+        sys_errno("Failed to get supplementary groups");
+        return janet_wrap_boolean(0);
+    }
+
+    for (int32_t i = 0; i < gids.len; i++)
+        new[i] = janet_getinteger(gids.items, i);
+
+    if (0 != syscall(SYS_SETGROUPS, (size_t) gids.len, new)) {
+        janet_sfree(old);
+        janet_sfree(new);
+        sys_errno("Failed to set supplementary groups");
+        return janet_wrap_boolean(0);
+    }
+
+    Janet *ret = janet_tuple_begin(count);
+    for (int i = 0; i < count; i++)
+        ret[i] = janet_wrap_integer(old[i]);
+
+    janet_sfree(old);
+    janet_sfree(new);
+
+    return janet_wrap_tuple(janet_tuple_end(ret));
+}
+#else /* not Linux */
+DEF_NOT_IMPL(cfun_setfsuid, "sys/setfsuid");
+DEF_NOT_IMPL(cfun_setfsgid, "sys/setfsgid");
+DEF_NOT_IMPL(cfun_setgroups, "sys/setgroups");
+#endif
+
+/* *nix: sys/resource.h, *: ? */
+static const struct {
+    const char *name;
+    int         resource;
+} sys_rlimits[] = {
+#ifdef RLIMIT_AS
+    { "as", RLIMIT_AS },
+#endif
+    { "core", RLIMIT_CORE },
+    { "cpu", RLIMIT_CPU },
+    { "data", RLIMIT_DATA },
+    { "fsize", RLIMIT_FSIZE },
+#ifdef RLIMIT_LOCKS
+    { "locks", RLIMIT_LOCKS },
+#endif
+#ifdef RLIMIT_MEMLOCK
+    { "memlock", RLIMIT_MEMLOCK },
+#endif
+#ifdef RLIMIT_MSGQUEUE
+    { "msgqueue", RLIMIT_MSGQUEUE },
+#endif
+#ifdef RLIMIT_NICE
+    { "nice", RLIMIT_NICE },
+#endif
+    { "nofile", RLIMIT_NOFILE },
+#ifdef RLIMIT_NPROC
+    { "nproc", RLIMIT_NPROC },
+#endif
+#ifdef RLIMIT_RSS
+    { "rss", RLIMIT_RSS },
+#endif
+#ifdef RLIMIT_RTPRIO
+    { "rtprio", RLIMIT_RTPRIO },
+#endif
+#ifdef RLIMIT_RTTIME
+    { "rttime", RLIMIT_RTTIME },
+#endif
+#ifdef RLIMIT_SIGPENDING
+    { "sigpending", RLIMIT_SIGPENDING },
+#endif
+    { "stack", RLIMIT_STACK },
+    { NULL, 0 }
+};
+
+static int sys_getrlimit_resource(const Janet *argv, int32_t n) {
+    for (int i = 0; sys_rlimits[i].name; i++)
+        if (janet_keyeq(argv[n], sys_rlimits[i].name))
+            return sys_rlimits[i].resource;
+
+    janet_panicf("Slot #%d must be a keyword naming a resource such as "
+                 ":nofile | :nproc | :core | :stack | :as, got %v",
+                 n + 1, argv[n]);
+    return -1;
+}
+
+/* `:infinity` for RLIM_INFINITY, nil to keep `dflt` */
+static rlim_t sys_optrlim(const Janet *argv, int32_t argc, int32_t n,
+                          rlim_t dflt) {
+    if (n >= argc || janet_checktype(argv[n], JANET_NIL))
+        return dflt;
+    if (janet_keyeq(argv[n], "infinity"))
+        return RLIM_INFINITY;
+    return (rlim_t) janet_getinteger64(argv, n);
+}
+
+static Janet sys_wrap_rlim(rlim_t lim) {
+    if (RLIM_INFINITY == lim)
+        return janet_ckeywordv("infinity");
+    return janet_wrap_number((double) lim);
+}
+
+static Janet sys_wrap_rlimit(struct rlimit *rl) {
+    JanetKV *ret = janet_struct_begin(2);
+    janet_struct_put(ret, janet_ckeywordv("soft"),
+                     sys_wrap_rlim(rl->rlim_cur));
+    janet_struct_put(ret, janet_ckeywordv("hard"),
+                     sys_wrap_rlim(rl->rlim_max));
+    return janet_wrap_struct(janet_struct_end(ret));
+}
+
+JANET_FN(cfun_getrlimit, SYS_FUSAGE("getrlimit", " resource"),
+         "-> _:struct limits|throws error_\n\n"
+         "\t`resource` **:keyword** _:as|:core|:cpu|:data|:fsize|:locks|"
+         ":memlock|:msgqueue|:nice|:nofile|:nproc|:rss|:rtprio|:rttime|"
+         ":sigpending|:stack_\n\n"
+         "\t**limits** {:soft `:number|:infinity` :hard "
+         "`:number|:infinity`}\n\n"
+         "Gets the soft and hard limits of this process on `resource`.") {
+    janet_fixarity(argc, 1);
+
+    int resource = sys_getrlimit_resource(argv, 0);
+    struct rlimit rl;
+
+    if (0 != getrlimit(resource, &rl)) {
+        sys_errnof("Failed to get resource limit: %v", argv[0]);
+        return janet_wrap_boolean(0);
+    }
+
+    return sys_wrap_rlimit(&rl);
+}
+
+JANET_FN(cfun_setrlimit, SYS_FUSAGE("setrlimit", " resource soft &opt hard"),
+         "-> _true|throws error_\n\n"
+         "\t`resource` **:keyword** _see `getrlimit`_\n\n"
+         "\t`soft`     **:number|:infinity|nil**\n\n"
+         "\t`hard`     **:number|:infinity|nil** _optional_\n\n"
+         "Sets the soft and hard limits of this process on `resource`, a nil "
+         "limit is left as it is. Limits are inherited by children created "
+         "with `fork` afterwards. Raising the hard limit requires "
+         "privileges.") {
+    janet_arity(argc, 2, 3);
+
+    int resource = sys_getrlimit_resource(argv, 0);
+    struct rlimit rl;
+
+    if (0 != getrlimit(resource, &rl)) {
+        sys_errnof("Failed to get resource limit: %v", argv[0]);
+        return janet_wrap_boolean(0);
+    }
+
+    rl.rlim_cur = sys_optrlim(argv, argc, 1, rl.rlim_cur);
+    rl.rlim_max = sys_optrlim(argv, argc, 2, rl.rlim_max);
+
+    if (0 != setrlimit(resource, &rl)) {
+        sys_errnof("Failed to set resource limit: %v", argv[0]);
+        return janet_wrap_boolean(0);
+    }
+
+    return janet_wrap_boolean(1);
+}
+
+#ifdef __linux__
+JANET_FN(cfun_prlimit,
+         SYS_FUSAGE("prlimit", " pid resource &opt soft hard"),
+         "-> _:struct previous-limits|throws error_\n\n"
+         "\t`pid`      **:number** _0 for this process_\n\n"
+         "\t`resource` **:keyword** _see `getrlimit`_\n\n"
+         "\t`soft`     **:number|:infinity|nil** _optional_\n\n"
+         "\t`hard`     **:number|:infinity|nil** _optional_\n\n"
+         "Gets, and when `soft` or `hard` are given sets, the limits of "
+         "process `pid` (such as a child returned by `fork`) on `resource`, "
+         "returning the limits as they were before. A nil limit is left as "
+         "it is. Linux only.") {
+    janet_arity(argc, 2, 4);
+
+    pid_t pid = janet_getinteger(argv, 0);
+    int resource = sys_getrlimit_resource(argv, 1);
+    struct rlimit old, new;
+
+    if (0 != prlimit(pid, resource, NULL, &old)) {
+        sys_errnof("Failed to get resource limit of pid: %d", pid);
+        return janet_wrap_boolean(0);
+    }
+
+    if (argc > 2) {
+        new.rlim_cur = sys_optrlim(argv, argc, 2, old.rlim_cur);
+        new.rlim_max = sys_optrlim(argv, argc, 3, old.rlim_max);
+
+        if (0 != prlimit(pid, resource, &new, &old)) {
+            sys_errnof("Failed to set resource limit of pid: %d", pid);
+            return janet_wrap_boolean(0);
+        }
+    }
+
+    return sys_wrap_rlimit(&old);
+}
+#else /* not Linux */
+DEF_NOT_IMPL(cfun_prlimit, "sys/prlimit");
+#endif
+
+JANET_FN(cfun_raise_rlimit, SYS_FUSAGE("raise-rlimit", " &opt resource pid"),
+         "-> _:number|:infinity soft-limit|throws error_\n\n"
+         "\t`resource` **:keyword** _see `getrlimit`, defaults to "
+         ":nofile_\n\n"
+         "\t`pid`      **:number** _optional, Linux only_\n\n"
+         "Raises the soft limit on `resource` up to the hard limit, for this "
+         "process or for process `pid`, returning the new soft limit. "
+         "Needs no privileges, and with the default of `:nofile` lifts the "
+         "usual 1024 descriptor cap up to whatever the system allows.") {
+    janet_arity(argc, 0, 2);
+
+    int resource = (argc > 0 && !janet_checktype(argv[0], JANET_NIL))
+        ? sys_getrlimit_resource(argv, 0) : RLIMIT_NOFILE;
+    struct rlimit rl;
+
+    if (argc > 1 && !janet_checktype(argv[1], JANET_NIL)) {
+#ifdef __linux__
+        pid_t pid = janet_getinteger(argv, 1);
+
+        if (0 != prlimit(pid, resource, NULL, &rl)) {
+            sys_errnof("Failed to get resource limit of pid: %d", pid);
+            return janet_wrap_boolean(0);
+        }
+
+        rl.rlim_cur = rl.rlim_max;
+
+        if (0 != prlimit(pid, resource, &rl, NULL)) {
+            sys_errnof("Failed to raise resource limit of pid: %d", pid);
+            return janet_wrap_boolean(0);
+        }
+
+        return sys_wrap_rlim(rl.rlim_cur);
+#else
+        janet_panic("Raising the limits of another process is only "
+                    "supported on Linux");
+        return janet_wrap_boolean(0);
+#endif
+    }
+
+    if (0 != getrlimit(resource, &rl)) {
+        sys_errno("Failed to get resource limit");
+        return janet_wrap_boolean(0);
+    }
+
+    rl.rlim_cur = rl.rlim_max;
+
+    if (0 != setrlimit(resource, &rl)) {
+        sys_errno("Failed to raise resource limit");
+        return janet_wrap_boolean(0);
+    }
+
+    return sys_wrap_rlim(rl.rlim_cur);
+}
+
 JANET_FN(cfun_setsid, SYS_FUSAGE0("setsid"),
          "-> _:number pid|throws error_\n\n"
          "Create a new session with no controlling terminal, becoming "
@@ -508,365 +1186,3667 @@ JANET_FN(cfun_getppid, SYS_FUSAGE0("getppid"),
     return janet_wrap_integer(getppid());
 }
 
-/* *nix: fcntl.h, *: ? */
-/* Only supporting F_GETLK, F_SETLK, and F_SETLK at this moment
- * Operates on open file handles only (os/open) or (file/open)
- * Using fcntl for lock files exclusively (no other methods), it supports
- * getting the pid of the process holding the lock, which the other
- * interfaces may not. */
-JANET_FN(cfun_fcntl, SYS_FUSAGE("fcntl", " file flag"),
-         "-> _:number pid|true|throws error_\n\n"
-         "\t`file` **:core/file**\n\n"
-         "\t`flag` **:keyword** _:get-lock|:set-lock|:wait-lock_\n\n"
-         "Only supporting file locking operations at this time, fnctl allows "
-         "you to either lock, or wait to get lock, or figure out the process "
-         "id currently holding the lock of the `file` dependent upon the "
-         "keyword `flag` passed to this. For all operations excepting "
-         "`:get-lock` returns true on success or throws an error on failure. "
-         "For operation `:get-lock` returns the pid of the process holding "
-         "the lock on success and throws an error on failure.") {
-    janet_fixarity(argc, 2);
+/* *nix: sys/resource.h, *: ? */
+/* Samplers fill a table that the caller may pass back in to be refilled in
+ * place. Keys are interned keywords and values plain numbers, so refilling
+ * a table that already holds every key allocates nothing. */
+static void sys_put_number(JanetTable *t, const char *key, double value) {
+    janet_table_put(t, janet_ckeywordv(key), janet_wrap_number(value));
+}
 
-    if(janet_checktype(argv[0], JANET_ABSTRACT)) {
-        int op = 0;
-        int fd;
-        if(-1 != (fd = file_to_fd(argv, 0))) {
-            if (janet_keyeq(argv[1], "get-lock"))
-                op = F_GETLK;
-            else if (janet_keyeq(argv[1], "set-lock"))
-                op = F_SETLK;
-            else if (janet_keyeq(argv[1], "wait-lock"))
-                op = F_SETLKW;
-            else {
-                janet_panic("Slot #2 must be a keyword equal to :get-lock "
-                            "| :set-lock | :wait-lock");
-                return janet_wrap_boolean(0);
-            }
-        } else {
-            janet_panic("Invalid File Handle");
-            return janet_wrap_boolean(0);
-        }
+static double sys_timeval_seconds(struct timeval tv) {
+    return (double) tv.tv_sec + (double) tv.tv_usec / 1e6;
+}
 
-        /* set up lock descriptor */
-        struct flock ld = { 0 };
-        ld.l_type = F_WRLCK;
-        ld.l_whence = SEEK_SET;
+static void sys_rusage_to_table(struct rusage *ru, JanetTable *t) {
+    sys_put_number(t, "user-time", sys_timeval_seconds(ru->ru_utime));
+    sys_put_number(t, "system-time", sys_timeval_seconds(ru->ru_stime));
+#ifdef __APPLE__
+    sys_put_number(t, "max-rss", (double) ru->ru_maxrss);
+#else /* kilobytes elsewhere */
+    sys_put_number(t, "max-rss", (double) ru->ru_maxrss * 1024);
+#endif
+    sys_put_number(t, "minor-faults", (double) ru->ru_minflt);
+    sys_put_number(t, "major-faults", (double) ru->ru_majflt);
+    sys_put_number(t, "block-inputs", (double) ru->ru_inblock);
+    sys_put_number(t, "block-outputs", (double) ru->ru_oublock);
+    sys_put_number(t, "voluntary-switches", (double) ru->ru_nvcsw);
+    sys_put_number(t, "involuntary-switches", (double) ru->ru_nivcsw);
+}
 
-        if (-1 == fcntl(fd, op, &ld)) {
-            switch (op) {
-            case F_GETLK:
-                sys_errno("Failed to get pid of process"
-                          " locking this file");
-                break;
-            case F_SETLK:
-                sys_errno("Failed to acquire a file lock");
-                break;
-            case F_SETLKW:
-                sys_errno("Failed while waiting to  acquire a file lock");
-                break;
-            }
+JANET_FN(cfun_getrusage, SYS_FUSAGE("getrusage", " &opt who into"),
+         "-> _:table usage|throws error_\n\n"
+         "\t`who`  **:keyword** _:self|:children|:thread, defaults to "
+         ":self_\n\n"
+         "\t`into` **:table** _optional_\n\n"
+         "\t**usage** @{:user-time `:number` :system-time `:number` "
+         ":max-rss `:number` :minor-faults `:number` :major-faults `:number` "
+         ":block-inputs `:number` :block-outputs `:number` "
+         ":voluntary-switches `:number` :involuntary-switches `:number`}\n\n"
+         "Gets the resource usage of this process, of its terminated and "
+         "waited for children, or of the calling thread (Linux only) "
+         "depending on `who`. Times are in seconds and `:max-rss` is in "
+         "bytes. The result is put in `into` when given, refilling it in "
+         "place, or in a new table otherwise.") {
+    janet_arity(argc, 0, 2);
+
+    int who = RUSAGE_SELF;
+    if (argc > 0 && !janet_checktype(argv[0], JANET_NIL)) {
+        if (janet_keyeq(argv[0], "self"))
+            who = RUSAGE_SELF;
+        else if (janet_keyeq(argv[0], "children"))
+            who = RUSAGE_CHILDREN;
+#ifdef RUSAGE_THREAD
+        else if (janet_keyeq(argv[0], "thread"))
+            who = RUSAGE_THREAD;
+#endif
+        else {
+            janet_panic("Slot #1 must be a keyword equal to :self "
+                        "| :children | :thread");
+            return janet_wrap_boolean(0);
         }
+    }
 
-        switch (op) {
-        case F_GETLK:
-            return janet_wrap_integer(ld.l_pid);
-            break;
-        default:
-            return janet_wrap_boolean(1);
-        }
-    } else {
-        janet_panic("Slot #1 must be a valid File Handle");
+    JanetTable *ret = janet_opttable(argv, argc, 1, 9);
+    struct rusage ru;
+
+    if (0 != getrusage(who, &ru)) {
+        sys_errno("Failed to get resource usage");
         return janet_wrap_boolean(0);
     }
 
-    return janet_wrap_boolean(1);
+    sys_rusage_to_table(&ru, ret);
+
+    return janet_wrap_table(ret);
 }
 
+#ifdef __linux__
+/* Reads all of the small /proc file at `path` into `buf`, NUL terminated */
+static int sys_read_proc(const char *path, char *buf, size_t len) {
+    int fd;
+    ssize_t n, total = 0;
+    char more;
+
+    if (-1 == (fd = open(path, O_RDONLY | O_CLOEXEC)))
+        return -1;
+
+    while ((size_t) total < len - 1
+           && 0 < (n = read(fd, buf + total, len - 1 - total)))
+        total += n;
+
+    /* a full buffer only holds all of it if the file ends right there */
+    if ((size_t) total == len - 1 && 0 < (n = read(fd, &more, 1))) {
+        n = -1;
+        errno = ENOBUFS;
+    }
+
+    close(fd);
+
+    if (-1 == n)
+        return -1;
+
+    buf[total] = '\0';
+    return 0;
+}
+
+/* Puts the value of the `field:` line of a /proc status file, times
+ * `scale`, under `key` of `t`, removing `key` if the line is missing */
+static void sys_put_status(JanetTable *t, const char *key,
+                           const char *status, const char *field,
+                           double scale) {
+    size_t len = strlen(field);
+
+    for (const char *line = status; line && *line;) {
+        if (0 == strncmp(line, field, len) && ':' == line[len]) {
+            sys_put_number(t, key, strtod(line + len + 1, NULL) * scale);
+            return;
+        }
+        if ((line = strchr(line, '\n')))
+            line++;
+    }
+
+    janet_table_remove(t, janet_ckeywordv(key));
+}
+
+JANET_FN(cfun_procstat, SYS_FUSAGE("procstat", " &opt pid into"),
+         "-> _:table stats|throws error_\n\n"
+         "\t`pid`  **:number** _optional, defaults to this process_\n\n"
+         "\t`into` **:table** _optional_\n\n"
+         "\t**stats** @{:pid `:number` :parent-pid `:number` "
+         ":user-time `:number` :system-time `:number` "
+         ":children-user-time `:number` :children-system-time `:number` "
+         ":minor-faults `:number` :major-faults `:number` "
+         ":threads `:number` :virtual-size `:number` :rss `:number` "
+         ":max-rss `:number` :voluntary-switches `:number` "
+         ":involuntary-switches `:number` :fds `:number`}\n\n"
+         "Samples the statistics of process `pid` (such as a child returned "
+         "by `fork`) from /proc/<pid>/stat, /proc/<pid>/status and "
+         "/proc/<pid>/fd. Times are in seconds and sizes in bytes. Fields "
+         "the kernel doesn't report (such as :max-rss of a zombie) are left "
+         "out. The result is put in `into` when given, refilling it in "
+         "place, or in a new table otherwise. Linux only.") {
+    janet_arity(argc, 0, 2);
+
+    int self = argc < 1 || janet_checktype(argv[0], JANET_NIL);
+    pid_t pid = self ? getpid() : (pid_t) janet_getinteger(argv, 0);
+    JanetTable *ret = janet_opttable(argv, argc, 1, 15);
+
+    char path[64];
+    char buf[16384]; /* status runs long with many CPUs or groups */
+    double tick = (double) sysconf(_SC_CLK_TCK);
+    double page = (double) sysconf(_SC_PAGESIZE);
+
+    /* stat, fields counted from the state which follows "(comm)" */
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int) pid);
+    if (0 != sys_read_proc(path, buf, sizeof(buf))) {
+        sys_errnof("Failed to read stats for pid: %d", (int) pid);
+        return janet_wrap_boolean(0);
+    }
+
+    char *p = strrchr(buf, ')');
+    unsigned long minflt, majflt, utime, stime, vsize;
+    long cutime, cstime, threads, rss;
+    int ppid;
+
+    if (!p || 10 != sscanf(p + 2,
+                           "%*c %d %*d %*d %*d %*d %*u %lu %*u %lu %*u "
+                           "%lu %lu %ld %ld %*d %*d %ld %*d %*u %lu %ld",
+                           &ppid, &minflt, &majflt, &utime, &stime,
+                           &cutime, &cstime, &threads, &vsize, &rss)) {
+        janet_panicf("Failed to parse stats for pid: %d", (int) pid);
+        return janet_wrap_boolean(0);
+    }
+
+    sys_put_number(ret, "pid", (double) pid);
+    sys_put_number(ret, "parent-pid", (double) ppid);
+    sys_put_number(ret, "user-time", (double) utime / tick);
+    sys_put_number(ret, "system-time", (double) stime / tick);
+    sys_put_number(ret, "children-user-time", (double) cutime / tick);
+    sys_put_number(ret, "children-system-time", (double) cstime / tick);
+    sys_put_number(ret, "minor-faults", (double) minflt);
+    sys_put_number(ret, "major-faults", (double) majflt);
+    sys_put_number(ret, "threads", (double) threads);
+    sys_put_number(ret, "virtual-size", (double) vsize);
+    sys_put_number(ret, "rss", (double) rss * page);
+
+    /* status, for what stat doesn't carry */
+    snprintf(path, sizeof(path), "/proc/%d/status", (int) pid);
+    if (0 != sys_read_proc(path, buf, sizeof(buf))) {
+        sys_errnof("Failed to read status for pid: %d", (int) pid);
+        return janet_wrap_boolean(0);
+    }
+
+    sys_put_status(ret, "max-rss", buf, "VmHWM", 1024);
+    sys_put_status(ret, "voluntary-switches", buf,
+                   "voluntary_ctxt_switches", 1);
+    sys_put_status(ret, "involuntary-switches", buf,
+                   "nonvoluntary_ctxt_switches", 1);
+
+    /* fd, one entry per open descriptor */
+    snprintf(path, sizeof(path), "/proc/%d/fd", (int) pid);
+    DIR *dir;
+    struct dirent *ent;
+    int fds = 0;
+
+    if (NULL == (dir = opendir(path))) {
+        sys_errnof("Failed to list descriptors for pid: %d", (int) pid);
+        return janet_wrap_boolean(0);
+    }
+
+    while ((ent = readdir(dir)))
+        if ('.' != ent->d_name[0])
+            fds++;
+
+    closedir(dir);
+
+    /* don't count the descriptor opendir used to do the counting */
+    sys_put_number(ret, "fds", (double) (self ? fds - 1 : fds));
+
+    return janet_wrap_table(ret);
+}
+#else /* not Linux */
+DEF_NOT_IMPL(cfun_procstat, "sys/procstat");
+#endif
+
+/* *nix: sched.h sys/resource.h, *: ? */
+static pid_t sys_optpid(const Janet *argv, int32_t argc, int32_t n) {
+    if (n >= argc || janet_checktype(argv[n], JANET_NIL))
+        return 0;
+    return (pid_t) janet_getinteger(argv, n);
+}
+
+static const struct {
+    const char *name;
+    int         policy;
+} sys_sched_policies[] = {
+    { "other", SCHED_OTHER },
+    { "fifo", SCHED_FIFO },
+    { "rr", SCHED_RR },
+#ifdef SCHED_BATCH
+    { "batch", SCHED_BATCH },
+#endif
+#ifdef SCHED_IDLE
+    { "idle", SCHED_IDLE },
+#endif
+    { NULL, 0 }
+};
+
+JANET_FN(cfun_sched_setscheduler,
+         SYS_FUSAGE("sched-setscheduler", " pid policy &opt priority"),
+         "-> _true|throws error_\n\n"
+         "\t`pid`      **:number|nil** _0 or nil for this process_\n\n"
+         "\t`policy`   **:keyword** _:other|:batch|:idle|:fifo|:rr_\n\n"
+         "\t`priority` **:number** _optional, defaults to 0, 1-99 for :fifo "
+         "and :rr_\n\n"
+         "Sets the scheduling policy and static priority of process `pid`. "
+         "The realtime policies :fifo and :rr require privileges.") {
+    janet_arity(argc, 2, 3);
+
+    pid_t pid = sys_optpid(argv, argc, 0);
+    struct sched_param param = { 0 };
+    int policy = -1;
+
+    for (int i = 0; sys_sched_policies[i].name; i++)
+        if (janet_keyeq(argv[1], sys_sched_policies[i].name))
+            policy = sys_sched_policies[i].policy;
+
+    if (-1 == policy) {
+        janet_panic("Slot #2 must be a keyword equal to :other | :batch "
+                    "| :idle | :fifo | :rr");
+        return janet_wrap_boolean(0);
+    }
+
+    param.sched_priority = janet_optinteger(argv, argc, 2, 0);
+
+    if (0 != sched_setscheduler(pid, policy, &param)) {
+        sys_errnof("Failed to set scheduler of pid: %d", pid);
+        return janet_wrap_boolean(0);
+    }
+
+    return janet_wrap_boolean(1);
+}
+
+JANET_FN(cfun_sched_getscheduler,
+         SYS_FUSAGE("sched-getscheduler", " &opt pid"),
+         "-> _:struct scheduling|throws error_\n\n"
+         "\t`pid` **:number** _optional, defaults to this process_\n\n"
+         "\t**scheduling** {:policy `:keyword` :priority `:number`}\n\n"
+         "Gets the scheduling policy and static priority of process "
+         "`pid`.") {
+    janet_arity(argc, 0, 1);
+
+    pid_t pid = sys_optpid(argv, argc, 0);
+    struct sched_param param;
+    int policy;
+
+    if (-1 == (policy = sched_getscheduler(pid))
+        || 0 != sched_getparam(pid, &param)) {
+        sys_errnof("Failed to get scheduler of pid: %d", pid);
+        return janet_wrap_boolean(0);
+    }
+
+    Janet name = janet_wrap_nil();
+    for (int i = 0; sys_sched_policies[i].name; i++)
+        if (policy == sys_sched_policies[i].policy)
+            name = janet_ckeywordv(sys_sched_policies[i].name);
+
+    JanetKV *ret = janet_struct_begin(2);
+    janet_struct_put(ret, janet_ckeywordv("policy"), name);
+    janet_struct_put(ret, janet_ckeywordv("priority"),
+                     janet_wrap_integer(param.sched_priority));
+
+    return janet_wrap_struct(janet_struct_end(ret));
+}
+
+JANET_FN(cfun_setpriority, SYS_FUSAGE("setpriority", " pid nice"),
+         "-> _true|throws error_\n\n"
+         "\t`pid`  **:number|nil** _0 or nil for this process_\n\n"
+         "\t`nice` **:number** _-20 (favored) to 19 (least favored)_\n\n"
+         "Sets the nice value of process `pid`. Lowering it requires "
+         "privileges.") {
+    janet_fixarity(argc, 2);
+
+    pid_t pid = sys_optpid(argv, argc, 0);
+    int nice = janet_getinteger(argv, 1);
+
+    if (0 != setpriority(PRIO_PROCESS, pid, nice)) {
+        sys_errnof("Failed to set nice value of pid: %d", pid);
+        return janet_wrap_boolean(0);
+    }
+
+    return janet_wrap_boolean(1);
+}
+
+JANET_FN(cfun_getpriority, SYS_FUSAGE("getpriority", " &opt pid"),
+         "-> _:number nice|throws error_\n\n"
+         "\t`pid` **:number** _optional, defaults to this process_\n\n"
+         "Gets the nice value of process `pid`.") {
+    janet_arity(argc, 0, 1);
+
+    pid_t pid = sys_optpid(argv, argc, 0);
+    int nice;
+
+    /* -1 is a valid nice value, only errno tells them apart */
+    errno = 0;
+    if (-1 == (nice = getpriority(PRIO_PROCESS, pid)) && errno) {
+        sys_errnof("Failed to get nice value of pid: %d", pid);
+        return janet_wrap_boolean(0);
+    }
+
+    return janet_wrap_integer(nice);
+}
+
+#ifdef __linux__
+JANET_FN(cfun_sched_setaffinity,
+         SYS_FUSAGE("sched-setaffinity", " pid cpus"),
+         "-> _true|throws error_\n\n"
+         "\t`pid`  **:number|nil** _0 or nil for this process_\n\n"
+         "\t`cpus` **:array|:tuple** _of :number_\n\n"
+         "Restricts process `pid` to running on the CPUs numbered in `cpus`, "
+         "for example pinning a worker right after `fork`. Linux only.") {
+    janet_fixarity(argc, 2);
+
+    pid_t pid = sys_optpid(argv, argc, 0);
+    JanetView cpus = janet_getindexed(argv, 1);
+    int max = 0;
+
+    for (int32_t i = 0; i < cpus.len; i++) {
+        int cpu = janet_getinteger(cpus.items, i);
+        if (cpu < 0 || cpu >= (1 << 20))
+            janet_panicf("Invalid CPU number: %d", cpu);
+        if (cpu >= max)
+            max = cpu + 1;
+    }
+
+    if (0 == max) {
+        janet_panic("Slot #2 must name at least one CPU");
+        return janet_wrap_boolean(0);
+    }
+
+    cpu_set_t *set = CPU_ALLOC(max);
+    size_t size = CPU_ALLOC_SIZE(max);
+
+    if (NULL == set) {
+        janet_panic("Out of memory");
+        return janet_wrap_boolean(0);
+    }
+
+    CPU_ZERO_S(size, set);
+    for (int32_t i = 0; i < cpus.len; i++)
+        CPU_SET_S(janet_getinteger(cpus.items, i), size, set);
+
+    if (0 != sched_setaffinity(pid, size, set)) {
+        CPU_FREE(set);
+        sys_errnof("Failed to set CPU affinity of pid: %d", pid);
+        return janet_wrap_boolean(0);
+    }
+
+    CPU_FREE(set);
+
+    return janet_wrap_boolean(1);
+}
+
+JANET_FN(cfun_sched_getaffinity,
+         SYS_FUSAGE("sched-getaffinity", " &opt pid"),
+         "-> _:array cpus|throws error_\n\n"
+         "\t`pid` **:number** _optional, defaults to this process_\n\n"
+         "Gets the numbers of the CPUs process `pid` may run on. Linux "
+         "only.") {
+    janet_arity(argc, 0, 1);
+
+    pid_t pid = sys_optpid(argv, argc, 0);
+    int max = 1024;
+    cpu_set_t *set;
+    size_t size;
+
+    /* the kernel's mask may be larger than the default cpu_set_t */
+    for (;;) {
+        set = CPU_ALLOC(max);
+        size = CPU_ALLOC_SIZE(max);
+
+        if (NULL == set) {
+            janet_panic("Out of memory");
+            return janet_wrap_boolean(0);
+        }
+
+        if (0 == sched_getaffinity(pid, size, set))
+            break;
+
+        CPU_FREE(set);
+
+        if (EINVAL != errno || max >= (1 << 20)) {
+            sys_errnof("Failed to get CPU affinity of pid: %d", pid);
+            return janet_wrap_boolean(0);
+        }
+
+        max *= 2;
+    }
+
+    JanetArray *ret = janet_array(CPU_COUNT_S(size, set));
+    for (int cpu = 0; cpu < max; cpu++)
+        if (CPU_ISSET_S(cpu, size, set))
+            janet_array_push(ret, janet_wrap_integer(cpu));
+
+    CPU_FREE(set);
+
+    return janet_wrap_array(ret);
+}
+
+/* From linux/ioprio.h, which isn't reliably installed */
+#define SYS_IOPRIO_CLASS_SHIFT  13
+#define SYS_IOPRIO_PRIO_MASK    ((1 << SYS_IOPRIO_CLASS_SHIFT) - 1)
+#define SYS_IOPRIO_WHO_PROCESS  1
+
+static const char *sys_ioprio_classes[] = {
+    "none", "realtime", "best-effort", "idle", NULL
+};
+
+JANET_FN(cfun_ioprio_set, SYS_FUSAGE("ioprio-set", " pid class &opt level"),
+         "-> _true|throws error_\n\n"
+         "\t`pid`   **:number|nil** _0 or nil for this process_\n\n"
+         "\t`class` **:keyword** _:none|:realtime|:best-effort|:idle_\n\n"
+         "\t`level` **:number** _optional, 0 (highest) to 7 (lowest), "
+         "defaults to 4_\n\n"
+         "Sets the I/O scheduling class and priority level of process "
+         "`pid`. The :realtime class requires privileges. Linux only.") {
+    janet_arity(argc, 2, 3);
+
+    pid_t pid = sys_optpid(argv, argc, 0);
+    int class = -1;
+    int level = janet_optinteger(argv, argc, 2, 4);
+
+    for (int i = 0; sys_ioprio_classes[i]; i++)
+        if (janet_keyeq(argv[1], sys_ioprio_classes[i]))
+            class = i;
+
+    if (-1 == class) {
+        janet_panic("Slot #2 must be a keyword equal to :none | :realtime "
+                    "| :best-effort | :idle");
+        return janet_wrap_boolean(0);
+    }
+
+    if (level < 0 || level > 7) {
+        janet_panicf("Slot #3 must be a level from 0 to 7, got %d", level);
+        return janet_wrap_boolean(0);
+    }
+
+    if (0 != syscall(SYS_ioprio_set, SYS_IOPRIO_WHO_PROCESS, pid,
+                     (class << SYS_IOPRIO_CLASS_SHIFT) | level)) {
+        sys_errnof("Failed to set I/O priority of pid: %d", pid);
+        return janet_wrap_boolean(0);
+    }
+
+    return janet_wrap_boolean(1);
+}
+
+JANET_FN(cfun_ioprio_get, SYS_FUSAGE("ioprio-get", " &opt pid"),
+         "-> _:struct io-priority|throws error_\n\n"
+         "\t`pid` **:number** _optional, defaults to this process_\n\n"
+         "\t**io-priority** {:class `:keyword` :level `:number`}\n\n"
+         "Gets the I/O scheduling class and priority level of process "
+         "`pid`. Linux only.") {
+    janet_arity(argc, 0, 1);
+
+    pid_t pid = sys_optpid(argv, argc, 0);
+    long prio;
+
+    if (-1 == (prio = syscall(SYS_ioprio_get, SYS_IOPRIO_WHO_PROCESS, pid))) {
+        sys_errnof("Failed to get I/O priority of pid: %d", pid);
+        return janet_wrap_boolean(0);
+    }
+
+    int class = (int) (prio >> SYS_IOPRIO_CLASS_SHIFT);
+
+    JanetKV *ret = janet_struct_begin(2);
+    janet_struct_put(ret, janet_ckeywordv("class"),
+                     class < 4 ? janet_ckeywordv(sys_ioprio_classes[class])
+                               : janet_wrap_integer(class));
+    janet_struct_put(ret, janet_ckeywordv("level"),
+                     janet_wrap_integer(prio & SYS_IOPRIO_PRIO_MASK));
+
+    return janet_wrap_struct(janet_struct_end(ret));
+}
+
+/* Parses a sysfs CPU list such as "0-3,8,10-11" onto `cpus` */
+static int sys_parse_cpulist(const char *path, JanetArray *cpus) {
+    char buf[4096];
+    char *p, *end;
+
+    if (0 != sys_read_proc(path, buf, sizeof(buf)))
+        return -1;
+
+    for (p = buf; *p && '\n' != *p;) {
+        long lo = strtol(p, &end, 10), hi = lo;
+
+        if (end == p)
+            break;
+        if ('-' == *end)
+            hi = strtol(end + 1, &end, 10);
+        for (long cpu = lo; cpu <= hi; cpu++)
+            janet_array_push(cpus, janet_wrap_integer((int32_t) cpu));
+
+        p = (',' == *end) ? end + 1 : end;
+    }
+
+    return 0;
+}
+
+JANET_FN(cfun_cpu_topology, SYS_FUSAGE0("cpu-topology"),
+         "-> _:struct topology|throws error_\n\n"
+         "\t**topology** {:cpus `:array` :nodes `:table`}\n\n"
+         "Lists the online CPUs, and the CPUs of each NUMA node keyed by "
+         "node number, as read from sysfs. Systems without NUMA support "
+         "report every online CPU in node 0. Meant for handing each forked "
+         "worker its own core or node with `sched-setaffinity`. Linux "
+         "only.") {
+    janet_fixarity(argc, 0);
+    (void) argv;
+
+    JanetArray *cpus = janet_array(16);
+    JanetTable *nodes = janet_table(2);
+
+    if (0 != sys_parse_cpulist("/sys/devices/system/cpu/online", cpus)) {
+        sys_errno("Failed to read the online CPUs");
+        return janet_wrap_boolean(0);
+    }
+
+    DIR *dir;
+    struct dirent *ent;
+
+    if (NULL != (dir = opendir("/sys/devices/system/node"))) {
+        char path[320];
+
+        while ((ent = readdir(dir))) {
+            char *end;
+            long node;
+
+            if (0 != strncmp(ent->d_name, "node", 4))
+                continue;
+            node = strtol(ent->d_name + 4, &end, 10);
+            if (end == ent->d_name + 4 || *end)
+                continue;
+
+            JanetArray *node_cpus = janet_array(8);
+            snprintf(path, sizeof(path),
+                     "/sys/devices/system/node/%s/cpulist", ent->d_name);
+            if (0 == sys_parse_cpulist(path, node_cpus))
+                janet_table_put(nodes, janet_wrap_integer((int32_t) node),
+                                janet_wrap_array(node_cpus));
+        }
+
+        closedir(dir);
+    }
+
+    if (0 == nodes->count)
+        janet_table_put(nodes, janet_wrap_integer(0), janet_wrap_array(cpus));
+
+    JanetKV *ret = janet_struct_begin(2);
+    janet_struct_put(ret, janet_ckeywordv("cpus"), janet_wrap_array(cpus));
+    janet_struct_put(ret, janet_ckeywordv("nodes"), janet_wrap_table(nodes));
+
+    return janet_wrap_struct(janet_struct_end(ret));
+}
+#else /* not Linux */
+DEF_NOT_IMPL(cfun_sched_setaffinity, "sys/sched-setaffinity");
+DEF_NOT_IMPL(cfun_sched_getaffinity, "sys/sched-getaffinity");
+DEF_NOT_IMPL(cfun_ioprio_set, "sys/ioprio-set");
+DEF_NOT_IMPL(cfun_ioprio_get, "sys/ioprio-get");
+DEF_NOT_IMPL(cfun_cpu_topology, "sys/cpu-topology");
+#endif
+
+/* *nix: fcntl.h, *: ? */
+/* File status and descriptor flags reachable through fcntl and pipe2 */
+static const struct {
+    const char *name;
+    int64_t     flag;
+} sys_fd_flags[] = {
+    { "nonblock", O_NONBLOCK },
+    { "append", O_APPEND },
+#ifdef O_DIRECT
+    { "direct", O_DIRECT },
+#endif
+    { "cloexec", U_CLOEXEC },
+    { NULL, 0 }
+};
+
+/* The keyword, or indexed of keywords, at `n` */
+static JanetView sys_getflagview(const Janet *argv, int32_t n) {
+    JanetView view;
+
+    if (janet_checktype(argv[n], JANET_KEYWORD)) {
+        view.items = &argv[n];
+        view.len = 1;
+    } else {
+        view = janet_getindexed(argv, n);
+    }
+
+    return view;
+}
+
+/* Flag of the keyword `key`, panics if it isn't one */
+static int64_t sys_getfdflag(Janet key) {
+    for (int f = 0; sys_fd_flags[f].name; f++)
+        if (janet_keyeq(key, sys_fd_flags[f].name))
+            return sys_fd_flags[f].flag;
+
+    janet_panicf("Unknown flag %v, must be one of :nonblock "
+                 "| :append | :direct | :cloexec", key);
+    return 0;
+}
+
+/* Flag mask of the keyword, or indexed of keywords, at `n` */
+static int64_t sys_getfdflags(const Janet *argv, int32_t n) {
+    JanetView view = sys_getflagview(argv, n);
+    int64_t flags = 0;
+
+    for (int32_t i = 0; i < view.len; i++)
+        flags |= sys_getfdflag(view.items[i]);
+
+    return flags;
+}
+
+/* The non locking operations of fcntl, returns 0 if `op` isn't one */
+static int sys_fcntl_flags(int fd, Janet op, int32_t argc, Janet *argv,
+                           Janet *ret) {
+    int64_t flags;
+    int err;
+
+    if (janet_keyeq(op, "get-flags")) {
+        if ((err = u_getflags(fd, &flags))) {
+            errno = err;
+            sys_errno("Failed to get file flags");
+        }
+
+        JanetArray *set = janet_array(4);
+        for (int f = 0; sys_fd_flags[f].name; f++)
+            if (flags & sys_fd_flags[f].flag)
+                janet_array_push(set, janet_ckeywordv(sys_fd_flags[f].name));
+
+        *ret = janet_wrap_array(set);
+    } else if (janet_keyeq(op, "set-flags")
+               || janet_keyeq(op, "clear-flags")) {
+        int enable = janet_keyeq(op, "set-flags");
+
+        janet_fixarity(argc, 3);
+        flags = sys_getfdflags(argv, 2);
+
+        for (int f = 0; sys_fd_flags[f].name; f++) {
+            if (!(flags & sys_fd_flags[f].flag))
+                continue;
+            if ((err = u_setflag(fd, sys_fd_flags[f].flag, enable))) {
+                errno = err;
+                sys_errnof("Failed to change file flag: %s",
+                           sys_fd_flags[f].name);
+            }
+        }
+
+        *ret = janet_wrap_boolean(1);
+#if defined(F_GETPIPE_SZ) && defined(F_SETPIPE_SZ)
+    } else if (janet_keyeq(op, "get-pipe-size")) {
+        int size;
+
+        if (-1 == (size = fcntl(fd, F_GETPIPE_SZ)))
+            sys_errno("Failed to get pipe size");
+
+        *ret = janet_wrap_integer(size);
+    } else if (janet_keyeq(op, "set-pipe-size")) {
+        int size;
+
+        janet_fixarity(argc, 3);
+
+        if (-1 == (size = fcntl(fd, F_SETPIPE_SZ, janet_getnat(argv, 2))))
+            sys_errno("Failed to set pipe size");
+
+        *ret = janet_wrap_integer(size);
+#endif
+    } else {
+        return 0;
+    }
+
+    return 1;
+}
+
+/* Lock operations only support F_GETLK, F_SETLK, and F_SETLKW at this
+ * moment. Operates on open file handles only (os/open) or (file/open)
+ * Using fcntl for lock files exclusively (no other methods), it supports
+ * getting the pid of the process holding the lock, which the other
+ * interfaces may not. */
+JANET_FN(cfun_fcntl, SYS_FUSAGE("fcntl", " file operation &opt argument"),
+         "-> _:number|:array|true|throws error_\n\n"
+         "\t`file`      **:core/file|:core/stream**\n\n"
+         "\t`operation` **:keyword** _:get-lock|:set-lock|:wait-lock|"
+         ":get-flags|:set-flags|:clear-flags|:get-pipe-size|"
+         ":set-pipe-size_\n\n"
+         "\t`argument`  **:keyword|:array|:tuple|:number** _optional_\n\n"
+         "Lock operations allow you to either lock, or wait to get lock, or "
+         "figure out the process id currently holding the lock of the "
+         "`file`. For operation `:get-lock` returns the pid of the process "
+         "holding the lock.\n\n"
+         "Flag operations get, set or clear the flags of `file`, among "
+         ":nonblock :append :direct and :cloexec. `:get-flags` returns "
+         "those set as an array, `:set-flags` and `:clear-flags` take the "
+         "flag or flags to change as `argument`.\n\n"
+         "Pipe size operations (Linux only) get, or set to `argument` bytes, "
+         "the capacity of the pipe `file`, returning the capacity in effect "
+         "afterwards which the kernel may have rounded up.\n\n"
+         "Operations that return nothing else return true on success, all "
+         "throw an error on failure.") {
+    janet_arity(argc, 2, 3);
+
+    if(janet_checktype(argv[0], JANET_ABSTRACT)) {
+        int op = 0;
+        int fd;
+        if(-1 != (fd = file_to_fd(argv, 0))) {
+            if (janet_keyeq(argv[1], "get-lock"))
+                op = F_GETLK;
+            else if (janet_keyeq(argv[1], "set-lock"))
+                op = F_SETLK;
+            else if (janet_keyeq(argv[1], "wait-lock"))
+                op = F_SETLKW;
+            else {
+                Janet ret;
+                if (sys_fcntl_flags(fd, argv[1], argc, argv, &ret))
+                    return ret;
+                janet_panic("Slot #2 must be a keyword equal to :get-lock "
+                            "| :set-lock | :wait-lock | :get-flags "
+                            "| :set-flags | :clear-flags | :get-pipe-size "
+                            "| :set-pipe-size");
+                return janet_wrap_boolean(0);
+            }
+        } else {
+            janet_panic("Invalid File Handle");
+            return janet_wrap_boolean(0);
+        }
+
+        /* set up lock descriptor */
+        struct flock ld = { 0 };
+        ld.l_type = F_WRLCK;
+        ld.l_whence = SEEK_SET;
+
+        if (-1 == fcntl(fd, op, &ld)) {
+            switch (op) {
+            case F_GETLK:
+                sys_errno("Failed to get pid of process"
+                          " locking this file");
+                break;
+            case F_SETLK:
+                sys_errno("Failed to acquire a file lock");
+                break;
+            case F_SETLKW:
+                sys_errno("Failed while waiting to  acquire a file lock");
+                break;
+            }
+        }
+
+        switch (op) {
+        case F_GETLK:
+            return janet_wrap_integer(ld.l_pid);
+            break;
+        default:
+            return janet_wrap_boolean(1);
+        }
+    } else {
+        janet_panic("Slot #1 must be a valid File Handle");
+        return janet_wrap_boolean(0);
+    }
+
+    return janet_wrap_boolean(1);
+}
+
+#ifdef JANET_EV
+static const JanetMethod sys_pipe_methods[] = {
+    { "close", janet_cfun_stream_close },
+    { "read", janet_cfun_stream_read },
+    { "chunk", janet_cfun_stream_chunk },
+    { "write", janet_cfun_stream_write },
+    { NULL, NULL }
+};
+
+JANET_FN(cfun_pipe2, SYS_FUSAGE("pipe2", " &opt flags capacity"),
+         "-> _:tuple [read-end write-end]|throws error_\n\n"
+         "\t`flags`    **:keyword|:array|:tuple** _optional, any of "
+         ":blocking :cloexec :direct_\n\n"
+         "\t`capacity` **:number** _optional, bytes, Linux only_\n\n"
+         "Creates a pipe, returning its ends as :core/streams, with `flags` "
+         "applied to both and its capacity enlarged to at least `capacity` "
+         "bytes. A larger pipe between forked stages means fewer context "
+         "switches per megabyte moved. Ends are non-blocking, as the event "
+         "loop (`ev/read` and the like) needs, unless :blocking is given; "
+         "blocking ends suit `dup2` onto stdin or stdout of a forked child "
+         "and must not be used with `ev/read` or `ev/write`. :direct makes "
+         "a packet mode pipe (Linux only).") {
+    janet_arity(argc, 0, 2);
+
+    int64_t flags = 0;
+    int32_t capacity = janet_optnat(argv, argc, 1, 0);
+    int blocking = 0;
+    int fds[2];
+    int err;
+
+    if (argc > 0 && !janet_checktype(argv[0], JANET_NIL)) {
+        JanetView view = sys_getflagview(argv, 0);
+
+        for (int32_t i = 0; i < view.len; i++)
+            if (janet_keyeq(view.items[i], "blocking"))
+                blocking = 1;
+            else
+                flags |= sys_getfdflag(view.items[i]);
+    }
+
+    if (blocking && (flags & O_NONBLOCK))
+        janet_panic("Pipe ends can't be both :blocking and :nonblock");
+
+    if (!blocking)
+        flags |= O_NONBLOCK;
+
+    if (flags & O_APPEND)
+        janet_panic("Pipes don't support :append");
+
+#if HAVE_PIPE2
+    if (0 != pipe2(fds, (int) (U_SYSFLAGS & flags))) {
+        sys_errno("Failed to create pipe");
+        return janet_wrap_boolean(0);
+    }
+#else
+    if (flags & ~(int64_t) (U_CLOEXEC | O_NONBLOCK))
+        janet_panic("Packet mode (:direct) pipes need pipe2, which this "
+                    "system lacks");
+
+    if (0 != pipe(fds)) {
+        sys_errno("Failed to create pipe");
+        return janet_wrap_boolean(0);
+    }
+
+    if ((err = u_fixflags(fds[0], flags))
+        || (err = u_fixflags(fds[1], flags))) {
+        close(fds[0]);
+        close(fds[1]);
+        errno = err;
+        sys_errno("Failed to set pipe flags");
+        return janet_wrap_boolean(0);
+    }
+#endif
+
+    if (capacity) {
+#ifdef F_SETPIPE_SZ
+        if (-1 == fcntl(fds[1], F_SETPIPE_SZ, capacity)) {
+            err = errno;
+            close(fds[0]);
+            close(fds[1]);
+            errno = err;
+            sys_errnof("Failed to set pipe capacity: %d", capacity);
+            return janet_wrap_boolean(0);
+        }
+#else
+        close(fds[0]);
+        close(fds[1]);
+        janet_panic("Setting pipe capacity isn't supported on this system");
+#endif
+    }
+    (void) err;
+
+    Janet *ret = janet_tuple_begin(2);
+    ret[0] = janet_wrap_abstract(
+        janet_stream(fds[0], JANET_STREAM_READABLE, sys_pipe_methods));
+    ret[1] = janet_wrap_abstract(
+        janet_stream(fds[1], JANET_STREAM_WRITABLE, sys_pipe_methods));
+
+    return janet_wrap_tuple(janet_tuple_end(ret));
+}
+#else /* no event loop, so no streams */
+DEF_NOT_IMPL(cfun_pipe2, "sys/pipe2");
+#endif
+
+#if defined(__linux__) && defined(JANET_EV)
+/* Tree jobs (chown-tree, walk): the root is handled on the calling thread,
+ * then a pool of detached threads drains a queue of open directory
+ * descriptors, working on each entry relative to its directory so no path
+ * is resolved twice. Reports go to a socket whose other end the caller
+ * reads as a stream of one tuple per line, the last thread out writes the
+ * summary and frees the job. */
+#define SYS_TREE_QUEUED  1024 /* most queued directories (open fds) */
+#define SYS_TREE_THREADS  256
+
+typedef struct SysTreeDir {
+    struct SysTreeDir *next;
+    int                fd;
+    int32_t            depth;
+    char              *path;
+} SysTreeDir;
+
+typedef struct SysTreeJob SysTreeJob;
+
+struct SysTreeJob {
+    pthread_mutex_t lock;      /* guards the queue and counts below */
+    pthread_cond_t  cond;
+    SysTreeDir     *queue;
+    int32_t         queued;
+    int32_t         busy;      /* threads working through a directory */
+    int32_t         threads;   /* threads still running */
+    int             started;   /* `threads` is final */
+    pthread_mutex_t report;    /* serializes writes to `out` */
+    int             out;
+    int             stopped;   /* stream closed, or the job is done early */
+    uint64_t        errors;
+    /* walks the directory open as `fd`, closing it when done */
+    void (*dir)(SysTreeJob *job, int fd, const char *path, int32_t depth);
+    /* sends the summary */
+    void (*done)(SysTreeJob *job);
+    /* frees what the job type adds, then the job */
+    void (*free)(SysTreeJob *job);
+};
+
+static const char *sys_strerror(int err, char *buf, size_t len) {
+#ifdef __GLIBC__
+    return strerror_r(err, buf, len);
+#else
+    strerror_r(err, buf, len);
+    return buf;
+#endif
+}
+
+/* Writes `s` to `out` as a Janet string literal, escaping anything that
+ * isn't printable ASCII so a report always fits on one line. `out` needs
+ * room for 4 bytes per byte of `s` plus 3. */
+static char *sys_quote(char *out, const char *s) {
+    static const char hex[] = "0123456789abcdef";
+
+    *out++ = '"';
+    for (; *s; s++) {
+        unsigned char c = (unsigned char) *s;
+
+        if ('"' == c || '\\' == c) {
+            *out++ = '\\';
+            *out++ = (char) c;
+        } else if (c < 0x20 || c >= 0x7f) {
+            *out++ = '\\';
+            *out++ = 'x';
+            *out++ = hex[c >> 4];
+            *out++ = hex[c & 0xf];
+        } else {
+            *out++ = (char) c;
+        }
+    }
+    *out++ = '"';
+    *out = '\0';
+
+    return out;
+}
+
+static char *sys_path_join(const char *dir, const char *name) {
+    size_t dlen = strlen(dir), nlen = strlen(name);
+    int slash = dlen && '/' != dir[dlen - 1];
+    char *path = malloc(dlen + slash + nlen + 1);
+
+    if (NULL == path)
+        return NULL;
+
+    memcpy(path, dir, dlen);
+    if (slash)
+        path[dlen] = '/';
+    memcpy(path + dlen + slash, name, nlen + 1);
+
+    return path;
+}
+
+static int sys_tree_stopped(SysTreeJob *job) {
+    return __atomic_load_n(&job->stopped, __ATOMIC_RELAXED);
+}
+
+static void sys_tree_stop(SysTreeJob *job) {
+    __atomic_store_n(&job->stopped, 1, __ATOMIC_RELAXED);
+    pthread_mutex_lock(&job->lock);
+    pthread_cond_broadcast(&job->cond);
+    pthread_mutex_unlock(&job->lock);
+}
+
+/* Sends whole report lines, `len` bytes of them, in one go so lines from
+ * different threads never interleave. */
+static void sys_tree_send(SysTreeJob *job, const char *lines, size_t len) {
+    pthread_mutex_lock(&job->report);
+    while (len && -1 != job->out) {
+        ssize_t sent = send(job->out, lines, len, MSG_NOSIGNAL);
+
+        if (sent < 0 && EINTR == errno)
+            continue;
+        if (sent < 0) {
+            /* nobody is listening anymore, stop everyone */
+            close(job->out);
+            job->out = -1;
+            sys_tree_stop(job);
+            break;
+        }
+        lines += sent;
+        len -= (size_t) sent;
+    }
+    pthread_mutex_unlock(&job->report);
+}
+
+static void sys_tree_error(SysTreeJob *job, const char *path,
+                           const char *op, int err) {
+    char msg[256];
+    char *line = malloc(strlen(path) * 4 + sizeof(msg) * 4 + 64);
+    char *end;
+
+    __atomic_fetch_add(&job->errors, 1, __ATOMIC_RELAXED);
+    if (NULL == line)
+        return;
+
+    end = line + sprintf(line, "[:error ");
+    end = sys_quote(end, path);
+    end += sprintf(end, " :%s ", op);
+    end = sys_quote(end, sys_strerror(err, msg, sizeof(msg)));
+    end += sprintf(end, "]\n");
+
+    sys_tree_send(job, line, (size_t) (end - line));
+    free(line);
+}
+
+/* Queues the directory open as `fd` for the pool, or walks it right here
+ * once the queue is full to keep the number of open descriptors
+ * bounded. */
+static void sys_tree_push(SysTreeJob *job, int fd, const char *path,
+                          int32_t depth) {
+    pthread_mutex_lock(&job->lock);
+    if (job->queued < SYS_TREE_QUEUED) {
+        SysTreeDir *dir = malloc(sizeof(SysTreeDir));
+        char *copy = strdup(path);
+
+        if (dir && copy) {
+            dir->fd = fd;
+            dir->depth = depth;
+            dir->path = copy;
+            dir->next = job->queue;
+            job->queue = dir;
+            job->queued++;
+            pthread_cond_signal(&job->cond);
+            pthread_mutex_unlock(&job->lock);
+            return;
+        }
+        free(dir);
+        free(copy);
+    }
+    pthread_mutex_unlock(&job->lock);
+
+    job->dir(job, fd, path, depth);
+}
+
+static void sys_tree_free(SysTreeJob *job) {
+    SysTreeDir *dir;
+
+    while ((dir = job->queue)) {
+        job->queue = dir->next;
+        close(dir->fd);
+        free(dir->path);
+        free(dir);
+    }
+
+    if (-1 != job->out)
+        close(job->out);
+    pthread_mutex_destroy(&job->lock);
+    pthread_mutex_destroy(&job->report);
+    pthread_cond_destroy(&job->cond);
+    job->free(job);
+}
+
+static void *sys_tree_worker(void *p) {
+    SysTreeJob *job = (SysTreeJob *) p;
+    int last;
+
+    pthread_mutex_lock(&job->lock);
+    while (!job->started)
+        pthread_cond_wait(&job->cond, &job->lock);
+    for (;;) {
+        SysTreeDir *dir;
+
+        while (!job->queue && job->busy && !sys_tree_stopped(job))
+            pthread_cond_wait(&job->cond, &job->lock);
+        if (!job->queue || sys_tree_stopped(job))
+            break;
+
+        dir = job->queue;
+        job->queue = dir->next;
+        job->queued--;
+        job->busy++;
+        pthread_mutex_unlock(&job->lock);
+
+        job->dir(job, dir->fd, dir->path, dir->depth);
+        free(dir->path);
+        free(dir);
+
+        pthread_mutex_lock(&job->lock);
+        if (0 == --job->busy && !job->queue)
+            pthread_cond_broadcast(&job->cond);
+    }
+    /* the queue is drained, or the job stopped, wake anyone waiting */
+    pthread_cond_broadcast(&job->cond);
+    last = 0 == --job->threads;
+    pthread_mutex_unlock(&job->lock);
+
+    if (last) {
+        job->done(job);
+        sys_tree_free(job);
+    }
+
+    return NULL;
+}
+
+/* Sets up `job`'s locks and report socket, returning the end to read
+ * reports from, or -1 with errno set, in which case `job` is untouched. */
+static int sys_tree_init(SysTreeJob *job) {
+    int fds[2];
+
+    if (0 != socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds))
+        return -1;
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    shutdown(fds[0], SHUT_WR);
+    shutdown(fds[1], SHUT_RD);
+
+    job->out = fds[1];
+    pthread_mutex_init(&job->lock, NULL);
+    pthread_mutex_init(&job->report, NULL);
+    pthread_cond_init(&job->cond, NULL);
+
+    return fds[0];
+}
+
+/* Hands `job`, its root already queued, to a pool of `threads` threads
+ * and returns the stream of its reports read from `in`. */
+static Janet sys_tree_start(SysTreeJob *job, int in, int32_t threads) {
+    pthread_attr_t attr;
+    pthread_t thread;
+    int err = 0, i;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    for (i = 0; i < threads; i++)
+        if ((err = pthread_create(&thread, &attr, sys_tree_worker, job)))
+            break;
+    pthread_attr_destroy(&attr);
+
+    if (0 == i) {
+        sys_tree_free(job);
+        close(in);
+        errno = err;
+        sys_errno("Failed to start threads");
+        return janet_wrap_boolean(0);
+    }
+
+    /* runs with however many threads started, which wait for the final
+     * count before doing anything. The last of them sends the summary,
+     * never this thread, as it'd block forever on a full socket that only
+     * this thread can drain. */
+    pthread_mutex_lock(&job->lock);
+    job->threads = i;
+    job->started = 1;
+    pthread_cond_broadcast(&job->cond);
+    pthread_mutex_unlock(&job->lock);
+
+    return janet_wrap_abstract(
+        janet_stream(in, JANET_STREAM_READABLE, sys_pipe_methods));
+}
+
+/* Thread count `x`, or `dflt` (such as the online CPUs) clamped into the
+ * same 1 to SYS_TREE_THREADS range when `x` is nil */
+static int32_t sys_getthreads(Janet x, long dflt) {
+    if (janet_checktype(x, JANET_NIL)) {
+        if (dflt < 1)
+            return 1;
+        if (dflt > SYS_TREE_THREADS)
+            return SYS_TREE_THREADS;
+        return (int32_t) dflt;
+    }
+
+    if (!janet_checkint(x) || janet_unwrap_integer(x) < 1
+        || janet_unwrap_integer(x) > SYS_TREE_THREADS)
+        janet_panicf("Thread counts must be from 1 to %d, got %v",
+                     SYS_TREE_THREADS, x);
+
+    return janet_unwrap_integer(x);
+}
+
+/* chown-tree ***************************************************************/
+#define SYS_CHOWN_PROGRESS 65536 /* entries between progress reports */
+
+typedef struct {
+    uint32_t from;
+    uint32_t to;
+} SysIdPair;
+
+/* nil keeps every id, a number replaces every id, a dictionary maps old
+ * ids to new ones and keeps the rest. */
+typedef struct {
+    enum { SYS_IDS_KEEP, SYS_IDS_ALL, SYS_IDS_MAP } kind;
+    uint32_t   all;
+    int32_t    count;
+    SysIdPair *pairs;
+} SysIdMap;
+
+typedef struct {
+    SysTreeJob tree;
+    uint64_t   visited;
+    uint64_t   changed;
+    SysIdMap   uids;
+    SysIdMap   gids;
+} SysChownJob;
+
+static int sys_idpair_cmp(const void *a, const void *b) {
+    uint32_t x = ((const SysIdPair *) a)->from;
+    uint32_t y = ((const SysIdPair *) b)->from;
+
+    return (x > y) - (x < y);
+}
+
+static int sys_checkid(Janet x) {
+    return janet_checkint64(x) && janet_unwrap_number(x) >= 0
+        && janet_unwrap_number(x) < (double) UINT32_MAX;
+}
+
+/* Panics unless slot `n` holds an id map, checked before any map is
+ * allocated so a panic can't leak one. */
+static void sys_checkidmap(const Janet *argv, int32_t n) {
+    JanetDictView dict;
+    const JanetKV *kv = NULL;
+
+    if (janet_checktype(argv[n], JANET_NIL))
+        return;
+
+    if (janet_checktype(argv[n], JANET_NUMBER)) {
+        if (!sys_checkid(argv[n]))
+            janet_panicf("Slot #%d must be a valid id", n + 1);
+        return;
+    }
+
+    dict = janet_getdictionary(argv, n);
+    while ((kv = janet_dictionary_next(dict.kvs, dict.cap, kv)))
+        if (!sys_checkid(kv->key) || !sys_checkid(kv->value))
+            janet_panicf("Slot #%d must map valid ids to valid ids", n + 1);
+}
+
+/* Reads the id map `sys_checkidmap` accepted from slot `n`, returning 0
+ * when out of memory. */
+static int sys_getidmap(const Janet *argv, int32_t n, SysIdMap *map) {
+    JanetDictView dict;
+    const JanetKV *kv = NULL;
+    int32_t i = 0;
+
+    map->kind = SYS_IDS_KEEP;
+    map->count = 0;
+    map->pairs = NULL;
+
+    if (janet_checktype(argv[n], JANET_NIL))
+        return 1;
+
+    if (janet_checktype(argv[n], JANET_NUMBER)) {
+        map->kind = SYS_IDS_ALL;
+        map->all = (uint32_t) janet_unwrap_number(argv[n]);
+        return 1;
+    }
+
+    dict = janet_getdictionary(argv, n);
+    map->kind = SYS_IDS_MAP;
+    map->pairs = malloc(sizeof(SysIdPair) * (dict.len ? dict.len : 1));
+    if (NULL == map->pairs)
+        return 0;
+
+    while ((kv = janet_dictionary_next(dict.kvs, dict.cap, kv))) {
+        map->pairs[i].from = (uint32_t) janet_unwrap_number(kv->key);
+        map->pairs[i].to = (uint32_t) janet_unwrap_number(kv->value);
+        i++;
+    }
+    map->count = i;
+    qsort(map->pairs, i, sizeof(SysIdPair), sys_idpair_cmp);
+
+    return 1;
+}
+
+/* Returns what `id` becomes, or -1 when it stays as it is */
+static uint32_t sys_idmap_lookup(SysIdMap *map, uint32_t id) {
+    SysIdPair key = { id, 0 }, *found;
+
+    switch (map->kind) {
+    case SYS_IDS_ALL:
+        return map->all == id ? (uint32_t) -1 : map->all;
+    case SYS_IDS_MAP:
+        found = bsearch(&key, map->pairs, map->count, sizeof(SysIdPair),
+                        sys_idpair_cmp);
+        return found && found->to != id ? found->to : (uint32_t) -1;
+    default:
+        return (uint32_t) -1;
+    }
+}
+
+static void sys_chown_counts(SysChownJob *job, const char *kind) {
+    char line[128];
+    int len = snprintf(
+        line, sizeof(line), "[:%s %llu %llu %llu]\n", kind,
+        (unsigned long long) __atomic_load_n(&job->visited, __ATOMIC_RELAXED),
+        (unsigned long long) __atomic_load_n(&job->changed, __ATOMIC_RELAXED),
+        (unsigned long long) __atomic_load_n(&job->tree.errors,
+                                             __ATOMIC_RELAXED));
+
+    sys_tree_send(&job->tree, line, (size_t) len);
+}
+
+/* Changes `name` in directory `dirfd`, `path` for reports */
+static void sys_chown_entry(SysChownJob *job, int dirfd, const char *name,
+                            const char *path) {
+    struct stat st;
+    uint32_t uid, gid;
+    int fd;
+
+    if (0 != fstatat(dirfd, name, &st, AT_SYMLINK_NOFOLLOW)) {
+        sys_tree_error(&job->tree, path, "stat", errno);
+        return;
+    }
+
+    if (0 == __atomic_add_fetch(&job->visited, 1, __ATOMIC_RELAXED)
+             % SYS_CHOWN_PROGRESS)
+        sys_chown_counts(job, "progress");
+
+    uid = sys_idmap_lookup(&job->uids, st.st_uid);
+    gid = sys_idmap_lookup(&job->gids, st.st_gid);
+    if ((uint32_t) -1 != uid || (uint32_t) -1 != gid) {
+        if (0 != fchownat(dirfd, name, (uid_t) uid, (gid_t) gid,
+                          AT_SYMLINK_NOFOLLOW))
+            sys_tree_error(&job->tree, path, "chown", errno);
+        else
+            __atomic_fetch_add(&job->changed, 1, __ATOMIC_RELAXED);
+    }
+
+    if (!S_ISDIR(st.st_mode))
+        return;
+
+    fd = openat(dirfd, name,
+                O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (-1 == fd) {
+        sys_tree_error(&job->tree, path, "open", errno);
+        return;
+    }
+
+    sys_tree_push(&job->tree, fd, path, 0);
+}
+
+static void sys_chown_dir(SysTreeJob *tree, int fd, const char *path,
+                          int32_t depth) {
+    SysChownJob *job = (SysChownJob *) tree;
+    DIR *dir = fdopendir(fd);
+    struct dirent *ent;
+
+    (void) depth;
+    if (NULL == dir) {
+        sys_tree_error(tree, path, "read", errno);
+        close(fd);
+        return;
+    }
+
+    for (;;) {
+        char *child;
+
+        errno = 0;
+        if (sys_tree_stopped(tree) || NULL == (ent = readdir(dir)))
+            break;
+
+        if ('.' == ent->d_name[0] && (!ent->d_name[1]
+            || ('.' == ent->d_name[1] && !ent->d_name[2])))
+            continue;
+
+        if (NULL == (child = sys_path_join(path, ent->d_name))) {
+            sys_tree_error(tree, path, "read", ENOMEM);
+            continue;
+        }
+        sys_chown_entry(job, dirfd(dir), ent->d_name, child);
+        free(child);
+    }
+    if (errno)
+        sys_tree_error(tree, path, "read", errno);
+
+    closedir(dir);
+}
+
+static void sys_chown_done(SysTreeJob *tree) {
+    sys_chown_counts((SysChownJob *) tree, "done");
+}
+
+static void sys_chown_free(SysTreeJob *tree) {
+    SysChownJob *job = (SysChownJob *) tree;
+
+    free(job->uids.pairs);
+    free(job->gids.pairs);
+    free(job);
+}
+
+JANET_FN(cfun_chown_tree,
+         SYS_FUSAGE("chown-tree", " path uid-map gid-map &opt threads"),
+         "-> _:core/stream|throws error_\n\n"
+         "\t`path`    **:string**\n\n"
+         "\t`uid-map` **:number|:table|:struct|nil** _the new owner, old "
+         "owners to new ones, or nil to keep owners_\n\n"
+         "\t`gid-map` **:number|:table|:struct|nil** _likewise for "
+         "groups_\n\n"
+         "\t`threads` **:number** _optional, defaults to the online "
+         "CPUs_\n\n"
+         "Changes the ownership of `path` and everything below it, on a "
+         "pool of `threads` threads in the background. Ids not in a map "
+         "are left alone. Symlinks are never followed, their own "
+         "ownership is changed instead. Returns a stream with a report "
+         "per line, each a tuple to `parse` (see `reports`): `[:progress "
+         "visited changed errors]` every 65536 entries, `[:error path op "
+         "message]` for each failure, then `[:done visited changed "
+         "errors]` before the stream ends. Closing the stream early "
+         "cancels the rest. Linux "
+         "only.") {
+    janet_arity(argc, 3, 4);
+
+    const char *path = janet_getcstring(argv, 0);
+    int32_t threads = sys_getthreads(argc > 3 ? argv[3] : janet_wrap_nil(),
+                                     sysconf(_SC_NPROCESSORS_ONLN));
+    SysIdMap uids = { 0 }, gids = { 0 };
+    SysChownJob *job;
+    int in, err;
+
+    sys_checkidmap(argv, 1);
+    sys_checkidmap(argv, 2);
+
+    if (!sys_getidmap(argv, 1, &uids) || !sys_getidmap(argv, 2, &gids)
+        || NULL == (job = calloc(1, sizeof(SysChownJob)))) {
+        free(uids.pairs);
+        free(gids.pairs);
+        janet_panic("Out of memory");
+    }
+    job->uids = uids;
+    job->gids = gids;
+    job->tree.dir = sys_chown_dir;
+    job->tree.done = sys_chown_done;
+    job->tree.free = sys_chown_free;
+
+    if (-1 == (in = sys_tree_init(&job->tree))) {
+        err = errno;
+        sys_chown_free(&job->tree);
+        errno = err;
+        sys_errno("Failed to create report socket");
+        return janet_wrap_boolean(0);
+    }
+
+    /* the root goes through the same path as everything else, so its
+     * failures are reported on the stream too */
+    sys_chown_entry(job, AT_FDCWD, path, path);
+
+    return sys_tree_start(&job->tree, in, threads);
+}
+
+/* walk *********************************************************************/
+#if defined(STATX_TYPE) && defined(SYS_getdents64)
+#define SYS_WALK_DENTS 65536 /* getdents64 buffer per directory */
+#define SYS_WALK_FLUSH 65536 /* report bytes batched before sending */
+
+/* What getdents64(2) fills its buffer with, glibc doesn't declare it */
+typedef struct {
+    uint64_t       d_ino;
+    int64_t        d_off;
+    unsigned short d_reclen;
+    unsigned char  d_type;
+    char           d_name[];
+} SysDirent64;
+
+/* Entry types, as named by os/stat's :mode */
+static const struct {
+    const char   *name;
+    unsigned char dtype;
+    mode_t        mode;
+} sys_walk_types[] = {
+    { "file", DT_REG, S_IFREG },
+    { "directory", DT_DIR, S_IFDIR },
+    { "link", DT_LNK, S_IFLNK },
+    { "fifo", DT_FIFO, S_IFIFO },
+    { "socket", DT_SOCK, S_IFSOCK },
+    { "block", DT_BLK, S_IFBLK },
+    { "character", DT_CHR, S_IFCHR },
+    { NULL, 0, 0 }
+};
+
+static const struct {
+    const char *name;
+    uint32_t    mask;
+} sys_walk_fields[] = {
+    { "mode", STATX_MODE },
+    { "uid", STATX_UID },
+    { "gid", STATX_GID },
+    { "size", STATX_SIZE },
+    { "blocks", STATX_BLOCKS },
+    { "nlink", STATX_NLINK },
+    { "ino", STATX_INO },
+    { "atime", STATX_ATIME },
+    { "mtime", STATX_MTIME },
+    { "ctime", STATX_CTIME },
+    { "btime", STATX_BTIME },
+    { NULL, 0 }
+};
+
+typedef struct {
+    SysTreeJob tree;
+    uint64_t   entries;   /* reported so far */
+    uint64_t   limit;     /* most entries to report, 0 for all */
+    uint32_t   mask;      /* statx fields wanted */
+    uint32_t   types;     /* bit per sys_walk_types to report, 0 for all */
+    int32_t    max_depth; /* -1 for no limit */
+    int        hidden;    /* include dotfiles */
+    int32_t    nprune;
+    char     **prune;     /* directory names not to descend into */
+} SysWalkJob;
+
+/* Report lines batched for one send */
+typedef struct {
+    char  *data;
+    size_t len;
+    size_t cap;
+} SysWalkOut;
+
+static int sys_walk_dtype(unsigned char dtype) {
+    for (int i = 0; sys_walk_types[i].name; i++)
+        if (sys_walk_types[i].dtype == dtype)
+            return i;
+    return -1;
+}
+
+static int sys_walk_mtype(mode_t mode) {
+    for (int i = 0; sys_walk_types[i].name; i++)
+        if (sys_walk_types[i].mode == (mode & S_IFMT))
+            return i;
+    return -1;
+}
+
+static void sys_walk_flush(SysWalkJob *job, SysWalkOut *out) {
+    if (out->len)
+        sys_tree_send(&job->tree, out->data, out->len);
+    out->len = 0;
+}
+
+/* Makes room for `len` more bytes in `out`, returning 0 when out of
+ * memory. */
+static int sys_walk_reserve(SysWalkOut *out, size_t len) {
+    if (out->len + len > out->cap) {
+        size_t cap = out->cap ? out->cap : SYS_WALK_FLUSH;
+        char *data;
+
+        while (cap < out->len + len)
+            cap *= 2;
+        if (NULL == (data = realloc(out->data, cap)))
+            return 0;
+        out->data = data;
+        out->cap = cap;
+    }
+
+    return 1;
+}
+
+static void sys_walk_report(SysWalkJob *job, SysWalkOut *out,
+                            const char *path, int type,
+                            struct statx *stx) {
+    uint32_t got = stx ? stx->stx_mask & job->mask : 0;
+    char *end;
+
+    if (!sys_walk_reserve(out, strlen(path) * 4 + 512)) {
+        sys_tree_error(&job->tree, path, "report", ENOMEM);
+        return;
+    }
+
+    end = out->data + out->len;
+    end += sprintf(end, "[:entry ");
+    end = sys_quote(end, path);
+    end += sprintf(end, " :%s",
+                   type < 0 ? "other" : sys_walk_types[type].name);
+
+    if (job->mask) {
+        end += sprintf(end, " {");
+        if (got & STATX_MODE)
+            end += sprintf(end, ":mode %u ", stx->stx_mode & 07777);
+        if (got & STATX_UID)
+            end += sprintf(end, ":uid %u ", stx->stx_uid);
+        if (got & STATX_GID)
+            end += sprintf(end, ":gid %u ", stx->stx_gid);
+        if (got & STATX_SIZE)
+            end += sprintf(end, ":size %llu ",
+                           (unsigned long long) stx->stx_size);
+        if (got & STATX_BLOCKS)
+            end += sprintf(end, ":blocks %llu ",
+                           (unsigned long long) stx->stx_blocks);
+        if (got & STATX_NLINK)
+            end += sprintf(end, ":nlink %u ", stx->stx_nlink);
+        if (got & STATX_INO)
+            end += sprintf(end, ":ino %llu ",
+                           (unsigned long long) stx->stx_ino);
+#define SYS_WALK_TIME(field, name)                                       \
+        if (got & field)                                                 \
+            end += sprintf(end, ":" #name " %.9f ",                      \
+                           (double) stx->stx_##name.tv_sec               \
+                           + stx->stx_##name.tv_nsec / 1e9);
+        SYS_WALK_TIME(STATX_ATIME, atime)
+        SYS_WALK_TIME(STATX_MTIME, mtime)
+        SYS_WALK_TIME(STATX_CTIME, ctime)
+        SYS_WALK_TIME(STATX_BTIME, btime)
+#undef SYS_WALK_TIME
+        if (' ' == end[-1])
+            end--;
+        *end++ = '}';
+    }
+    end += sprintf(end, "]\n");
+    out->len = (size_t) (end - out->data);
+
+    if (out->len >= SYS_WALK_FLUSH)
+        sys_walk_flush(job, out);
+}
+
+/* Reports `name` in directory `dirfd` (`path` in reports), `dtype` from
+ * its directory entry, and descends into it when it's a directory. A
+ * statx is only made when fields were asked for or the filesystem didn't
+ * give the type. */
+static void sys_walk_entry(SysWalkJob *job, SysWalkOut *out, int dirfd,
+                           const char *name, const char *path,
+                           unsigned char dtype, int32_t depth) {
+    struct statx stx, *have = NULL;
+    int type = DT_UNKNOWN == dtype ? -1 : sys_walk_dtype(dtype);
+    int fd;
+
+    if (job->mask || DT_UNKNOWN == dtype) {
+        if (0 != statx(dirfd, name, AT_SYMLINK_NOFOLLOW,
+                       job->mask | STATX_TYPE, &stx)) {
+            sys_tree_error(&job->tree, path, "stat", errno);
+            return;
+        }
+        have = &stx;
+        type = sys_walk_mtype(stx.stx_mode);
+    }
+
+    if (!job->types || (type >= 0 && (job->types & (1u << type)))) {
+        uint64_t n = __atomic_fetch_add(&job->entries, 1, __ATOMIC_RELAXED);
+
+        if (job->limit && n >= job->limit) {
+            sys_tree_stop(&job->tree);
+            return;
+        }
+        sys_walk_report(job, out, path, type, have);
+    }
+
+    if (type < 0 || S_IFDIR != sys_walk_types[type].mode
+        || (-1 != job->max_depth && depth >= job->max_depth))
+        return;
+    for (int32_t i = 0; i < job->nprune; i++)
+        if (0 == strcmp(name, job->prune[i]))
+            return;
+
+    fd = openat(dirfd, name,
+                O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (-1 == fd) {
+        sys_tree_error(&job->tree, path, "open", errno);
+        return;
+    }
+
+    /* what's batched so far goes first, walking inline may take a while */
+    sys_walk_flush(job, out);
+    sys_tree_push(&job->tree, fd, path, depth + 1);
+}
+
+static void sys_walk_dir(SysTreeJob *tree, int fd, const char *path,
+                         int32_t depth) {
+    SysWalkJob *job = (SysWalkJob *) tree;
+    SysWalkOut out = { NULL, 0, 0 };
+    char *dents = malloc(SYS_WALK_DENTS);
+    long len = 0;
+
+    if (NULL == dents) {
+        sys_tree_error(tree, path, "read", ENOMEM);
+        close(fd);
+        return;
+    }
+
+    while (!sys_tree_stopped(tree)
+           && 0 < (len = syscall(SYS_getdents64, fd, dents,
+                                 SYS_WALK_DENTS))) {
+        for (long off = 0; off < len && !sys_tree_stopped(tree);) {
+            SysDirent64 *ent = (SysDirent64 *) (dents + off);
+            const char *name = ent->d_name;
+            char *child;
+
+            off += ent->d_reclen;
+            if ('.' == name[0] && (!job->hidden || !name[1]
+                || ('.' == name[1] && !name[2])))
+                continue;
+
+            if (NULL == (child = sys_path_join(path, name))) {
+                sys_tree_error(tree, path, "read", ENOMEM);
+                continue;
+            }
+            sys_walk_entry(job, &out, fd, name, child, ent->d_type,
+                           depth);
+            free(child);
+        }
+    }
+    if (len < 0)
+        sys_tree_error(tree, path, "read", errno);
+
+    sys_walk_flush(job, &out);
+    free(out.data);
+    free(dents);
+    close(fd);
+}
+
+static void sys_walk_done(SysTreeJob *tree) {
+    SysWalkJob *job = (SysWalkJob *) tree;
+    uint64_t entries = __atomic_load_n(&job->entries, __ATOMIC_RELAXED);
+    char line[128];
+    int len = snprintf(
+        line, sizeof(line), "[:done %llu %llu]\n",
+        (unsigned long long) (job->limit && entries > job->limit
+                              ? job->limit : entries),
+        (unsigned long long) __atomic_load_n(&tree->errors,
+                                             __ATOMIC_RELAXED));
+
+    sys_tree_send(tree, line, (size_t) len);
+}
+
+static void sys_walk_free(SysTreeJob *tree) {
+    SysWalkJob *job = (SysWalkJob *) tree;
+
+    for (int32_t i = 0; i < job->nprune; i++)
+        free(job->prune[i]);
+    free(job->prune);
+    free(job);
+}
+
+static Janet sys_walk_opt(JanetDictView opts, const char *name) {
+    if (NULL == opts.kvs)
+        return janet_wrap_nil();
+
+    return janet_dictionary_get(opts.kvs, opts.cap, janet_ckeywordv(name));
+}
+
+/* Fills `job`'s options in from `opts`, panicking before anything is
+ * allocated. */
+static void sys_walk_options(SysWalkJob *job, JanetDictView opts,
+                             int32_t *threads, JanetView *prune) {
+    Janet x;
+
+    job->max_depth = -1;
+    prune->len = 0;
+
+    x = sys_walk_opt(opts, "max-depth");
+    if (!janet_checktype(x, JANET_NIL)) {
+        if (!janet_checkint(x) || janet_unwrap_integer(x) < 0)
+            janet_panicf(":max-depth must be at least 0, got %v", x);
+        job->max_depth = janet_unwrap_integer(x);
+    }
+
+    x = sys_walk_opt(opts, "limit");
+    if (!janet_checktype(x, JANET_NIL)) {
+        if (!janet_checkint64(x) || janet_unwrap_number(x) < 1)
+            janet_panicf(":limit must be at least 1, got %v", x);
+        job->limit = (uint64_t) janet_unwrap_number(x);
+    }
+
+    job->hidden = janet_truthy(sys_walk_opt(opts, "hidden"));
+
+    x = sys_walk_opt(opts, "fields");
+    if (!janet_checktype(x, JANET_NIL)) {
+        JanetView fields;
+
+        if (!janet_indexed_view(x, &fields.items, &fields.len))
+            janet_panicf(":fields must be a tuple or array, got %v", x);
+        for (int32_t i = 0; i < fields.len; i++) {
+            int j;
+
+            for (j = 0; sys_walk_fields[j].name; j++)
+                if (janet_keyeq(fields.items[i], sys_walk_fields[j].name))
+                    break;
+            if (!sys_walk_fields[j].name)
+                janet_panicf("Unknown field %v, expected :mode :uid :gid "
+                             ":size :blocks :nlink :ino :atime :mtime "
+                             ":ctime or :btime", fields.items[i]);
+            job->mask |= sys_walk_fields[j].mask;
+        }
+    }
+
+    x = sys_walk_opt(opts, "types");
+    if (!janet_checktype(x, JANET_NIL)) {
+        JanetView types;
+
+        if (!janet_indexed_view(x, &types.items, &types.len))
+            janet_panicf(":types must be a tuple or array, got %v", x);
+        for (int32_t i = 0; i < types.len; i++) {
+            int j;
+
+            for (j = 0; sys_walk_types[j].name; j++)
+                if (janet_keyeq(types.items[i], sys_walk_types[j].name))
+                    break;
+            if (!sys_walk_types[j].name)
+                janet_panicf("Unknown type %v, expected :file :directory "
+                             ":link :fifo :socket :block or :character",
+                             types.items[i]);
+            job->types |= 1u << j;
+        }
+    }
+
+    x = sys_walk_opt(opts, "prune");
+    if (!janet_checktype(x, JANET_NIL)) {
+        if (!janet_indexed_view(x, &prune->items, &prune->len))
+            janet_panicf(":prune must be a tuple or array, got %v", x);
+        for (int32_t i = 0; i < prune->len; i++)
+            if (!janet_checktypes(prune->items[i], JANET_TFLAG_BYTES))
+                janet_panicf(":prune must hold directory names, got %v",
+                             prune->items[i]);
+    }
+
+    *threads = sys_getthreads(sys_walk_opt(opts, "threads"), 1);
+}
+
+JANET_FN(cfun_walk, SYS_FUSAGE("walk", " path &opt opts"),
+         "-> _:core/stream|throws error_\n\n"
+         "\t`path` **:string**\n\n"
+         "\t`opts` **:table|:struct** _optional, any of:_\n\n"
+         "\t\t`:fields` **:tuple** _stat fields to report, any of :mode "
+         ":uid :gid :size :blocks :nlink :ino :atime :mtime :ctime "
+         ":btime_\n\n"
+         "\t\t`:types` **:tuple** _only report these, any of :file "
+         ":directory :link :fifo :socket :block :character_\n\n"
+         "\t\t`:max-depth` **:number** _0 for `path` alone_\n\n"
+         "\t\t`:prune` **:tuple** _names of directories not to enter_\n\n"
+         "\t\t`:hidden` **:boolean** _include dotfiles_\n\n"
+         "\t\t`:limit` **:number** _stop after this many entries_\n\n"
+         "\t\t`:threads` **:number** _walk subtrees in parallel, defaults "
+         "to 1_\n\n"
+         "Walks the tree at `path` in the background without following "
+         "symlinks, reading directories in large batches and only calling "
+         "statx for the requested `:fields` (or when a filesystem doesn't "
+         "give entry types). Returns a stream of reports, sent in large "
+         "chunks, one per line and each a tuple to `parse` (see "
+         "`reports`): `[:entry path type fields]` for every entry, with "
+         "`fields` a struct only when `:fields` is given and times in "
+         "seconds, `[:error path op message]` for each failure, then "
+         "`[:done entries errors]` before the stream ends. Entries come "
+         "in no particular order with more than one thread. Closing the "
+         "stream early cancels the rest. Linux only.") {
+    janet_arity(argc, 1, 2);
+
+    const char *path = janet_getcstring(argv, 0);
+    JanetDictView opts = { NULL, 0, 0 };
+    JanetView prune;
+    SysWalkJob *job, options = { 0 };
+    int32_t threads;
+    int in, err;
+
+    if (argc > 1 && !janet_checktype(argv[1], JANET_NIL))
+        opts = janet_getdictionary(argv, 1);
+    sys_walk_options(&options, opts, &threads, &prune);
+
+    if (NULL == (job = malloc(sizeof(SysWalkJob))))
+        janet_panic("Out of memory");
+    *job = options;
+    job->tree.dir = sys_walk_dir;
+    job->tree.done = sys_walk_done;
+    job->tree.free = sys_walk_free;
+
+    if (prune.len && NULL == (job->prune = calloc(prune.len,
+                                                  sizeof(char *)))) {
+        sys_walk_free(&job->tree);
+        janet_panic("Out of memory");
+    }
+    for (int32_t i = 0; i < prune.len; i++) {
+        JanetByteView name = janet_getbytes(prune.items, i);
+
+        if (NULL == (job->prune[i] = strndup((const char *) name.bytes,
+                                             name.len))) {
+            sys_walk_free(&job->tree);
+            janet_panic("Out of memory");
+        }
+        job->nprune++;
+    }
+
+    if (-1 == (in = sys_tree_init(&job->tree))) {
+        err = errno;
+        sys_walk_free(&job->tree);
+        errno = err;
+        sys_errno("Failed to create report socket");
+        return janet_wrap_boolean(0);
+    }
+
+    /* the root, at depth 0, is reported and queued like anything else */
+    SysWalkOut out = { NULL, 0, 0 };
+    sys_walk_entry(job, &out, AT_FDCWD, path, path, DT_UNKNOWN, 0);
+    sys_walk_flush(job, &out);
+    free(out.data);
+
+    return sys_tree_start(&job->tree, in, threads);
+}
+#else /* no statx or getdents64 */
+DEF_NOT_IMPL(cfun_walk, "sys/walk");
+#endif
+#else /* no threads and streams to report through */
+DEF_NOT_IMPL(cfun_chown_tree, "sys/chown-tree");
+DEF_NOT_IMPL(cfun_walk, "sys/walk");
+#endif
+
 /* *nix: pwd.h, *: ? */
 /* uses janet struct for a thing with fields... */
 /* Definition from:
  *   https://github.com/wahern/lunix/blob/master/src/unix.c */
-static int u_getpwuid_r(
-    uid_t uid, struct passwd *pwd, char *buf, size_t bufsiz,
-    struct passwd **res) {
-#if GETPWUID_R_NETBSD
-    int error;
-    errno = 0;
-    return (error = getpwuid_r(uid, pwd, buf, bufsiz, res))? error : errno;
+static int u_getpwuid_r(
+    uid_t uid, struct passwd *pwd, char *buf, size_t bufsiz,
+    struct passwd **res) {
+#if GETPWUID_R_NETBSD
+    int error;
+    errno = 0;
+    return (error = getpwuid_r(uid, pwd, buf, bufsiz, res))? error : errno;
+#else
+    return getpwuid_r(uid, pwd, buf, bufsiz, res);
+#endif
+}
+
+/* Definition from:
+ *   https://github.com/wahern/lunix/blob/master/src/unix.c */
+static int u_getpwnam_r(
+    const char *nam, struct passwd *pwd, char *buf,
+    size_t bufsiz, struct passwd **res) {
+#if GETPWNAM_R_NETBSD
+    int error;
+    errno = 0;
+    return (error = getpwnam_r(nam, pwd, buf, bufsiz, res))? error : errno;
+#else
+    return getpwnam_r(nam, pwd, buf, bufsiz, res);
+#endif
+}
+
+static int sys_getpwuid(
+    uid_t uid, struct passwd **ent, char *buf, size_t len) {
+    int err;
+    struct passwd tmp;
+
+    while((err = u_getpwuid_r(uid, &tmp, buf, len, ent))) {
+        if (err != ERANGE)
+            return err;
+        if (janet_srealloc(buf, sizeof(char) * (len + 128)))
+            return err;
+
+        len += 128;
+        /* TODO: Limit to a reasonable maximal bound */
+        *ent = NULL;
+    }
+
+    return 0;
+}
+
+static int sys_getpwnam(
+    const char* user, struct passwd **ent, char *buf, size_t len) {
+    int err;
+    struct passwd tmp;
+
+    while((err = u_getpwnam_r(user, &tmp, buf, len, ent))) {
+        if (err != ERANGE)
+            return err;
+        if (janet_srealloc(buf, sizeof(char) * (len + 128)))
+            return err;
+
+        len += 128;
+        /* TODO: Limit to a reasonable maximal bound */
+        *ent = NULL;
+    }
+
+    return 0;
+}
+
+/* Definition from:
+ *   https://github.com/wahern/lunix/blob/master/src/unix.c */
+static int u_getgrgid_r(
+    gid_t gid, struct group *grp, char *buf, size_t bufsiz,
+    struct group **res) {
+#if GETGRGID_R_NETBSD
+	int error;
+	errno = 0;
+	return (error = getgrgid_r(gid, grp, buf, bufsiz, res))? error : errno;
 #else
-    return getpwuid_r(uid, pwd, buf, bufsiz, res);
+	return getgrgid_r(gid, grp, buf, bufsiz, res);
+#endif
+}
+
+/* Definition from:
+ *   https://github.com/wahern/lunix/blob/master/src/unix.c */
+static int u_getgrnam_r(
+    const char *nam, struct group *grp, char *buf, size_t bufsiz,
+    struct group **res) {
+#if GETGRNAM_R_NETBSD
+	int error;
+	errno = 0;
+	return (error = getgrnam_r(nam, grp, buf, bufsiz, res))? error : errno;
+#else
+	return getgrnam_r(nam, grp, buf, bufsiz, res);
+#endif
+}
+
+static int sys_getgrid(
+    gid_t gid, struct group **ent, char *buf, size_t len) {
+    int err;
+    struct group tmp;
+
+    while ((err = u_getgrgid_r(gid, &tmp, buf, len, ent))) {
+        if (err != ERANGE)
+            return err;
+        if (janet_srealloc(buf, sizeof(char) * (len + 128)))
+            return err;
+
+        len += 128;
+        /* TODO: Limit to a reasonable maximal bound */
+        *ent = NULL;
+    }
+
+    return 0;
+}
+
+static int sys_getgrnam(
+    const char *name, struct group **ent, char *buf, size_t len) {
+    int err;
+    struct group tmp;
+
+    while ((err = u_getgrnam_r(name, &tmp, buf, len, ent))) {
+        if (err != ERANGE)
+            return err;
+        if (janet_srealloc(buf, sizeof(char) * (len + 128)))
+            return err;
+
+        len += 128;
+        /* TODO: Limit to a reasonable maximal bound */
+        *ent = NULL;
+    }
+
+    return 0;
+}
+
+int sys_name_opt(Janet *argv) {
+    return janet_checktype(argv[0], JANET_NUMBER) ? 1 : 0;
+}
+
+/* TODO: maybe a nicer doc string? */
+JANET_FN(cfun_getpwnam, SYS_FUSAGE0("getpwnam id-or-username"),
+         "-> _:struct user-details|throws error\n\n"
+         "\t`id-or-username` **:number|:string**\n\n"
+         "\t**user-details** {:user-name `:string` :password `:string` "
+         ":user-id `:number` :group-id `:number` :home-directory `:string` "
+         ":shell `:string` :gecos `:string`}\n\n"
+         "Gets the details on a username specified by id or by username with "
+         "`id-or-username`.") {
+    janet_fixarity(argc, 1);
+
+    struct passwd *ent;
+    char  *buf = (char *)janet_smalloc(sizeof(char) * 128);
+
+    /* did we get an ID? or a Name? */
+    switch(sys_name_opt(argv)) {
+        case 1: /* is int */
+            if(0 != sys_getpwuid(janet_getinteger(argv, 0), &ent, buf, 128)) {
+                sys_errnof("No entry for uid: %d", janet_getinteger(argv, 0));
+                return janet_wrap_boolean(0);
+            }
+            break;
+        case 0: /* is string */
+            if(0 != sys_getpwnam(janet_getcstring(argv, 0), &ent, buf, 128)) {
+                sys_errnof("No entry for username: %s",
+                           janet_getcstring(argv, 0));
+                return janet_wrap_boolean(0);
+            }
+            break;
+    }
+
+    /* extract info */
+    /* TODO: support the time_t fields? */
+    JanetKV *ret = janet_struct_begin(7);
+    janet_struct_put(ret,
+                     janet_ckeywordv("user-name"),
+                     janet_wrap_string(janet_cstring(ent->pw_name)));
+    janet_struct_put(ret,
+                     janet_ckeywordv("password"),
+                     janet_wrap_string(janet_cstring(ent->pw_passwd)));
+    janet_struct_put(ret,
+                     janet_ckeywordv("user-id"),
+                     janet_wrap_integer(ent->pw_uid));
+    janet_struct_put(ret,
+                     janet_ckeywordv("group-id"),
+                     janet_wrap_integer(ent->pw_gid));
+    janet_struct_put(ret,
+                     janet_ckeywordv("home-directory"),
+                     janet_wrap_string(janet_cstring(ent->pw_dir)));
+    janet_struct_put(ret,
+                     janet_ckeywordv("shell"),
+                     janet_wrap_string(janet_cstring(ent->pw_shell)));
+    janet_struct_put(ret,
+                     janet_ckeywordv("gecos"),
+                     janet_wrap_string(janet_cstring(ent->pw_gecos)));
+
+    /* copy out above! */
+    janet_sfree(buf);
+
+    return janet_wrap_struct(janet_struct_end(ret));
+}
+
+/* *nix: grp.h, *: ? */
+JANET_FN(cfun_getgrnam, SYS_FUSAGE("getgrnam", " id-or-groupname"),
+         "-> _:struct group-details|thows error_\n\n"
+         "\t`id-or-groupname` **:number|:string**\n\n"
+         "\t**user-details** {:group-name `:string` :password `:string` "
+         ":group-id `:number`}\n\n"
+         "Gets the details on a group specified by id or by group name with "
+         "`id-or-username`") {
+    janet_fixarity(argc, 1);
+
+    struct group *ent;
+    char  *buf = (char *)janet_smalloc(sizeof(char) * 128);
+
+    /* did we get an ID? or a Name? */
+    switch(sys_name_opt(argv)) {
+        case 1: /* is int */
+            if(0 != sys_getgrid(janet_getinteger(argv, 0), &ent, buf, 128)) {
+                sys_errnof("No entry for uid: %d", janet_getinteger(argv, 0));
+                return janet_wrap_boolean(0);
+            }
+            break;
+        case 0: /* is string */
+            if(0 != sys_getgrnam(janet_getcstring(argv, 0), &ent, buf, 128)) {
+                sys_errnof("No entry for username: %s",
+                           janet_getcstring(argv, 0));
+                return janet_wrap_boolean(0);
+            }
+            break;
+    }
+
+    /* extract info */
+    /* TODO: support the time_t fields? */
+    JanetKV *ret = janet_struct_begin(4);
+    janet_struct_put(ret,
+                     janet_ckeywordv("group-name"),
+                     janet_wrap_string(janet_cstring(ent->gr_name)));
+    janet_struct_put(ret,
+                     janet_ckeywordv("password"),
+                     janet_wrap_string(janet_cstring(ent->gr_passwd)));
+    janet_struct_put(ret,
+                     janet_ckeywordv("group-id"),
+                     janet_wrap_integer(ent->gr_gid));
+
+    /* handle members as tuple */
+    int len = 0;
+    for(; ent->gr_mem[len]; len++)
+        ;;
+
+    Janet *mem = janet_malloc(sizeof(Janet) * len);
+
+    for(int i = 0; ent->gr_mem[i]; i++) {
+       mem[i] = janet_wrap_string(janet_cstring(ent->gr_mem[i]));
+    }
+
+    janet_struct_put(ret,
+                    janet_ckeywordv("group-members"),
+                    janet_wrap_tuple(janet_tuple_n(mem, len)));
+
+    const JanetStruct r = janet_struct_end(ret);
+
+    /* copy out above! */
+    janet_sfree(buf);
+
+    return janet_wrap_struct(r);
+}
+
+/* nix: stdio.h, *: ?*/
+int file_to_fd(Janet *argv, int idx) {
+    if(janet_checkfile(argv[idx]))
+        return fileno(janet_unwrapfile(argv[idx], NULL));
+#ifdef JANET_EV
+    JanetStream *stream = janet_checkabstract(argv[idx], &janet_stream_type);
+    if (stream && !(stream->flags & JANET_STREAM_CLOSED))
+        return stream->handle;
+#endif
+    return -1;
+}
+
+JANET_FN(cfun_fileno, SYS_FUSAGE("fileno", " file"),
+         "-> _:number|throws error_\n\n"
+         "\t`file` **:core/file|:core/stream**\n\n"
+         "Returns the integer file descriptor from a :core/file or an open "
+         ":core/stream.") {
+    int ret;
+    if (-1 != (ret = file_to_fd(argv , 0)))
+        return janet_wrap_integer(ret);
+
+    janet_panic("Invalid File Handle");
+    return janet_wrap_boolean(0);
+}
+
+/* *nix: fcntl.h unistd.h, *: ? */
+static int sys_getfd(Janet *argv, int idx) {
+    int fd;
+
+    if (-1 == (fd = file_to_fd(argv, idx)))
+        janet_panicf("Slot #%d must be a valid File Handle", idx + 1);
+
+    return fd;
+}
+
+/* Data written through a :core/file may still sit in its stdio buffer, which
+ * syncing the descriptor alone would miss. */
+static void sys_flushfile(Janet *argv, int idx) {
+    if (janet_checkfile(argv[idx]))
+        fflush(janet_unwrapfile(argv[idx], NULL));
+}
+
+/* posix_fallocate(3) and posix_fadvise(2) are missing on some systems
+ * (macOS), which don't define the advice constants either */
+#if defined(__linux__) || defined(POSIX_FADV_NORMAL)
+JANET_FN(cfun_fallocate,
+         SYS_FUSAGE("fallocate", " file offset length &opt flags"),
+         "-> _true|throws error_\n\n"
+         "\t`file`   **:core/file|:core/stream**\n\n"
+         "\t`offset` **:number**\n\n"
+         "\t`length` **:number**\n\n"
+         "\t`flags`  **:keyword** _optional, any of :keep-size "
+         ":punch-hole :zero-range :collapse-range :insert-range, Linux "
+         "only_\n\n"
+         "Allocates the disk space for `length` bytes of `file` starting at "
+         "`offset` up front, so a growing segment or log isn't extended (and "
+         "fragmented) a block at a time. Uses fallocate(2) where available "
+         "and posix_fallocate(3) otherwise. `flags` select the other "
+         "operations of fallocate(2), such as punching holes.") {
+    janet_arity(argc, 3, 8);
+
+    int fd = sys_getfd(argv, 0);
+    off_t offset = (off_t) janet_getinteger64(argv, 1);
+    off_t length = (off_t) janet_getinteger64(argv, 2);
+    int mode = 0;
+    int err;
+
+    for (int32_t i = 3; i < argc; i++) {
+#ifdef __linux__
+        if (janet_keyeq(argv[i], "keep-size"))
+            mode |= FALLOC_FL_KEEP_SIZE;
+        else if (janet_keyeq(argv[i], "punch-hole"))
+            mode |= FALLOC_FL_PUNCH_HOLE;
+        else if (janet_keyeq(argv[i], "zero-range"))
+            mode |= FALLOC_FL_ZERO_RANGE;
+        else if (janet_keyeq(argv[i], "collapse-range"))
+            mode |= FALLOC_FL_COLLAPSE_RANGE;
+        else if (janet_keyeq(argv[i], "insert-range"))
+            mode |= FALLOC_FL_INSERT_RANGE;
+        else
+#endif
+        janet_panicf("Slot #%d must be a keyword equal to :keep-size "
+                     "| :punch-hole | :zero-range | :collapse-range "
+                     "| :insert-range", i + 1);
+    }
+
+#ifdef __linux__
+    if (0 == fallocate(fd, mode, offset, length))
+        return janet_wrap_boolean(1);
+
+    /* posix_fallocate(3) covers filesystems lacking fallocate(2), by
+     * writing out zeroes if need be */
+    if (EOPNOTSUPP != errno || mode) {
+        sys_errno("Failed to allocate file space");
+        return janet_wrap_boolean(0);
+    }
+#else
+    (void) mode;
 #endif
+
+    /* posix_fallocate(3) returns the error rather than setting errno */
+    if ((err = posix_fallocate(fd, offset, length))) {
+        errno = err;
+        sys_errno("Failed to allocate file space");
+        return janet_wrap_boolean(0);
+    }
+
+    return janet_wrap_boolean(1);
 }
 
-/* Definition from:
- *   https://github.com/wahern/lunix/blob/master/src/unix.c */
-static int u_getpwnam_r(
-    const char *nam, struct passwd *pwd, char *buf,
-    size_t bufsiz, struct passwd **res) {
-#if GETPWNAM_R_NETBSD
-    int error;
-    errno = 0;
-    return (error = getpwnam_r(nam, pwd, buf, bufsiz, res))? error : errno;
+JANET_FN(cfun_fadvise,
+         SYS_FUSAGE("fadvise", " file advice &opt offset length"),
+         "-> _true|throws error_\n\n"
+         "\t`file`   **:core/file|:core/stream**\n\n"
+         "\t`advice` **:keyword** _:normal|:sequential|:random|:willneed|"
+         ":dontneed|:noreuse_\n\n"
+         "\t`offset` **:number** _optional, defaults to 0_\n\n"
+         "\t`length` **:number** _optional, defaults to 0 (to the end of "
+         "the file)_\n\n"
+         "Tells the kernel how `file` will be accessed between `offset` and "
+         "`offset` + `length`, tuning readahead and caching, e.g. "
+         ":sequential to read ahead aggressively or :dontneed to drop pages "
+         "already written out.") {
+    janet_arity(argc, 2, 4);
+
+    int fd = sys_getfd(argv, 0);
+    off_t offset = (off_t) janet_optinteger64(argv, argc, 2, 0);
+    off_t length = (off_t) janet_optinteger64(argv, argc, 3, 0);
+    int advice;
+    int err;
+
+    if (janet_keyeq(argv[1], "normal"))
+        advice = POSIX_FADV_NORMAL;
+    else if (janet_keyeq(argv[1], "sequential"))
+        advice = POSIX_FADV_SEQUENTIAL;
+    else if (janet_keyeq(argv[1], "random"))
+        advice = POSIX_FADV_RANDOM;
+    else if (janet_keyeq(argv[1], "willneed"))
+        advice = POSIX_FADV_WILLNEED;
+    else if (janet_keyeq(argv[1], "dontneed"))
+        advice = POSIX_FADV_DONTNEED;
+    else if (janet_keyeq(argv[1], "noreuse"))
+        advice = POSIX_FADV_NOREUSE;
+    else {
+        janet_panic("Slot #2 must be a keyword equal to :normal "
+                    "| :sequential | :random | :willneed | :dontneed "
+                    "| :noreuse");
+        return janet_wrap_boolean(0);
+    }
+
+    /* posix_fadvise(2) returns the error rather than setting errno */
+    if ((err = posix_fadvise(fd, offset, length, advice))) {
+        errno = err;
+        sys_errno("Failed to advise on file access");
+        return janet_wrap_boolean(0);
+    }
+
+    return janet_wrap_boolean(1);
+}
+#else /* no posix_fallocate or posix_fadvise */
+DEF_NOT_IMPL(cfun_fallocate, "sys/fallocate");
+DEF_NOT_IMPL(cfun_fadvise, "sys/fadvise");
+#endif
+
+JANET_FN(cfun_fdatasync, SYS_FUSAGE("fdatasync", " file"),
+         "-> _true|throws error_\n\n"
+         "\t`file` **:core/file|:core/stream**\n\n"
+         "Flushes the data of `file` to disk, along with only the metadata "
+         "needed to read it back (such as a changed size), which spares the "
+         "inode update a full fsync(2) does for timestamps.") {
+    janet_fixarity(argc, 1);
+
+    int fd = sys_getfd(argv, 0);
+
+    sys_flushfile(argv, 0);
+
+#if defined(__linux__) || (defined(_POSIX_SYNCHRONIZED_IO) \
+                           && _POSIX_SYNCHRONIZED_IO > 0)
+    if (0 != fdatasync(fd)) {
 #else
-    return getpwnam_r(nam, pwd, buf, bufsiz, res);
+    /* no fdatasync(2) (macOS), sync the metadata along with the data */
+    if (0 != fsync(fd)) {
 #endif
+        sys_errno("Failed to sync file data");
+        return janet_wrap_boolean(0);
+    }
+
+    return janet_wrap_boolean(1);
 }
 
-static int sys_getpwuid(
-    uid_t uid, struct passwd **ent, char *buf, size_t len) {
-    int err;
-    struct passwd tmp;
+#ifdef __linux__
+JANET_FN(cfun_sync_file_range,
+         SYS_FUSAGE("sync-file-range", " file offset length &opt flags"),
+         "-> _true|throws error_\n\n"
+         "\t`file`   **:core/file|:core/stream**\n\n"
+         "\t`offset` **:number**\n\n"
+         "\t`length` **:number** _0 for to the end of the file_\n\n"
+         "\t`flags`  **:keyword** _optional, any of :wait-before :write "
+         ":wait-after, defaults to :write_\n\n"
+         "Starts (:write) and/or waits for (:wait-before, :wait-after) the "
+         "write out of the dirty pages of `file` in the given range, so "
+         "write back can be kicked off in batches well before a durability "
+         "point. Gives no durability guarantee by itself, as metadata isn't "
+         "written, pair it with `fdatasync`. Linux only.") {
+    janet_arity(argc, 3, 6);
+
+    int fd = sys_getfd(argv, 0);
+    off_t offset = (off_t) janet_getinteger64(argv, 1);
+    off_t length = (off_t) janet_getinteger64(argv, 2);
+    unsigned int flags = argc > 3 ? 0 : SYNC_FILE_RANGE_WRITE;
+
+    for (int32_t i = 3; i < argc; i++) {
+        if (janet_keyeq(argv[i], "wait-before"))
+            flags |= SYNC_FILE_RANGE_WAIT_BEFORE;
+        else if (janet_keyeq(argv[i], "write"))
+            flags |= SYNC_FILE_RANGE_WRITE;
+        else if (janet_keyeq(argv[i], "wait-after"))
+            flags |= SYNC_FILE_RANGE_WAIT_AFTER;
+        else
+            janet_panicf("Slot #%d must be a keyword equal to :wait-before "
+                         "| :write | :wait-after", i + 1);
+    }
 
-    while((err = u_getpwuid_r(uid, &tmp, buf, len, ent))) {
-        if (err != ERANGE)
-            return err;
-        if (janet_srealloc(buf, sizeof(char) * (len + 128)))
-            return err;
+    sys_flushfile(argv, 0);
 
-        len += 128;
-        /* TODO: Limit to a reasonable maximal bound */
-        *ent = NULL;
+    if (0 != sync_file_range(fd, offset, length, flags)) {
+        sys_errno("Failed to sync file range");
+        return janet_wrap_boolean(0);
     }
 
+    return janet_wrap_boolean(1);
+}
+#else /* not Linux */
+DEF_NOT_IMPL(cfun_sync_file_range, "sys/sync-file-range");
+#endif
+
+/* *nix: sys/mman.h, *: ? */
+/* A shared memory object: a descriptor (from memfd_create, shm_open or
+ * passed in) plus a MAP_SHARED mapping of all of it. The mapping and the
+ * descriptor both survive `fork`, so a region made before forking is shared
+ * with every worker, and the descriptor can be handed to unrelated
+ * processes to map with `shm-map`. Objects sealed against writes, or whose
+ * descriptor is read-only, are mapped privately and read-only instead, as
+ * the kernel refuses a shared writable mapping of them. */
+typedef struct {
+    int      fd;
+    int      writable;
+    size_t   size;
+    uint8_t *map;
+} SysShm;
+
+static int sys_shm_gc(void *p, size_t len) {
+    SysShm *shm = (SysShm *) p;
+    (void) len;
+
+    if (shm->map)
+        munmap(shm->map, shm->size);
+    if (-1 != shm->fd)
+        close(shm->fd);
+
+    shm->map = NULL;
+    shm->fd = -1;
+
     return 0;
 }
 
-static int sys_getpwnam(
-    const char* user, struct passwd **ent, char *buf, size_t len) {
+static int sys_shm_get(void *p, Janet key, Janet *out);
+
+static const JanetAbstractType sys_shm_type = {
+    "sys/shm",
+    sys_shm_gc,
+    NULL,
+    sys_shm_get,
+    JANET_ATEND_GET
+};
+
+static const JanetMethod sys_shm_methods[] = {
+    { "resize", cfun_shm_resize },
+    { "seal", cfun_shm_seal },
+    { "view", cfun_shm_view },
+    { "read", cfun_shm_read },
+    { "write", cfun_shm_write },
+    { "close", cfun_shm_close },
+    { NULL, NULL }
+};
+
+static int sys_shm_get(void *p, Janet key, Janet *out) {
+    SysShm *shm = (SysShm *) p;
+
+    if (!janet_checktype(key, JANET_KEYWORD))
+        return 0;
+
+    if (janet_keyeq(key, "size")) {
+        *out = janet_wrap_number((double) shm->size);
+        return 1;
+    }
+    if (janet_keyeq(key, "fd")) {
+        *out = janet_wrap_integer(shm->fd);
+        return 1;
+    }
+    if (janet_keyeq(key, "writable")) {
+        *out = janet_wrap_boolean(shm->writable);
+        return 1;
+    }
+
+    return janet_getmethod(janet_unwrap_keyword(key), sys_shm_methods, out);
+}
+
+static SysShm *sys_getshm(const Janet *argv, int32_t n) {
+    SysShm *shm = janet_getabstract(argv, n, &sys_shm_type);
+
+    if (-1 == shm->fd)
+        janet_panicf("Slot #%d must be an open shared memory object", n + 1);
+
+    return shm;
+}
+
+/* As sys_getshm, also requiring the mapping to be writable */
+static SysShm *sys_getshm_rw(const Janet *argv, int32_t n) {
+    SysShm *shm = sys_getshm(argv, n);
+
+    if (!shm->writable)
+        janet_panicf("Slot #%d must be a writable shared memory object, "
+                     "it's read-only or sealed against writes", n + 1);
+
+    return shm;
+}
+
+/* Whether `fd` may be mapped shared and writable */
+static int sys_shm_writable(int fd) {
+    int flags = fcntl(fd, F_GETFL);
+
+    if (-1 != flags && O_RDONLY == (flags & O_ACCMODE))
+        return 0;
+#ifdef F_GET_SEALS
+    flags = fcntl(fd, F_GET_SEALS);
+    if (-1 != flags && (flags & F_SEAL_WRITE))
+        return 0;
+#endif
+
+    return 1;
+}
+
+/* Maps `size` bytes of `fd` the way a shm that is (or isn't) `writable`
+ * maps them. */
+static void *sys_shm_mmap(int fd, size_t size, int writable) {
+    return writable
+        ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+        : mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+}
+
+/* Maps `fd` (sized to `size` first when `size` isn't -1) into a new shm
+ * object, closing `fd` on failure. */
+static Janet sys_shm_new(int fd, int64_t size) {
+    struct stat st;
     int err;
-    struct passwd tmp;
 
-    while((err = u_getpwnam_r(user, &tmp, buf, len, ent))) {
-        if (err != ERANGE)
-            return err;
-        if (janet_srealloc(buf, sizeof(char) * (len + 128)))
-            return err;
+    if (-1 != size && 0 != ftruncate(fd, (off_t) size))
+        goto fail;
 
-        len += 128;
-        /* TODO: Limit to a reasonable maximal bound */
-        *ent = NULL;
+    if (0 != fstat(fd, &st))
+        goto fail;
+
+    SysShm *shm = janet_abstract(&sys_shm_type, sizeof(SysShm));
+    shm->fd = -1;
+    shm->writable = sys_shm_writable(fd);
+    shm->size = (size_t) st.st_size;
+    shm->map = NULL;
+
+    if (shm->size && MAP_FAILED == (shm->map = sys_shm_mmap(
+                        fd, shm->size, shm->writable))) {
+        shm->map = NULL;
+        goto fail;
     }
 
-    return 0;
+    shm->fd = fd;
+    return janet_wrap_abstract(shm);
+
+fail:
+    err = errno;
+    close(fd);
+    errno = err;
+    sys_errno("Failed to map shared memory");
+    return janet_wrap_boolean(0);
 }
 
-/* Definition from:
- *   https://github.com/wahern/lunix/blob/master/src/unix.c */
-static int u_getgrgid_r(
-    gid_t gid, struct group *grp, char *buf, size_t bufsiz,
-    struct group **res) {
-#if GETGRGID_R_NETBSD
-	int error;
-	errno = 0;
-	return (error = getgrgid_r(gid, grp, buf, bufsiz, res))? error : errno;
-#else
-	return getgrgid_r(gid, grp, buf, bufsiz, res);
+#ifdef MFD_CLOEXEC
+JANET_FN(cfun_memfd_create,
+         SYS_FUSAGE("memfd-create", " name size & flags"),
+         "-> _:sys/shm|throws error_\n\n"
+         "\t`name`  **:string** _for debugging only, need not be unique_\n\n"
+         "\t`size`  **:number** _bytes_\n\n"
+         "\t`flags` **:keyword** _optional, any of :cloexec "
+         ":allow-sealing :hugetlb_\n\n"
+         "Creates an anonymous shared memory object of `size` bytes, mapped "
+         "read-write. It lives only as long as it's mapped or its descriptor "
+         "is open somewhere, and is shared with children created by `fork` "
+         "afterwards. Pass :allow-sealing to be able to `shm-seal` it. "
+         "Linux only.") {
+    janet_arity(argc, 2, 5);
+
+    const char *name = janet_getcstring(argv, 0);
+    int64_t size = janet_getinteger64(argv, 1);
+    unsigned int flags = 0;
+    int fd;
+
+    if (size < 0)
+        janet_panic("Slot #2 must be a size of at least 0");
+
+    for (int32_t i = 2; i < argc; i++) {
+        if (janet_keyeq(argv[i], "cloexec"))
+            flags |= MFD_CLOEXEC;
+        else if (janet_keyeq(argv[i], "allow-sealing"))
+            flags |= MFD_ALLOW_SEALING;
+#ifdef MFD_HUGETLB
+        else if (janet_keyeq(argv[i], "hugetlb"))
+            flags |= MFD_HUGETLB;
 #endif
+        else
+            janet_panicf("Slot #%d must be a keyword equal to :cloexec "
+                         "| :allow-sealing | :hugetlb", i + 1);
+    }
+
+    if (-1 == (fd = memfd_create(name, flags))) {
+        sys_errnof("Failed to create memfd: %s", name);
+        return janet_wrap_boolean(0);
+    }
+
+    return sys_shm_new(fd, size);
 }
+#else /* no memfd */
+DEF_NOT_IMPL(cfun_memfd_create, "sys/memfd-create");
+#endif
 
-/* Definition from:
- *   https://github.com/wahern/lunix/blob/master/src/unix.c */
-static int u_getgrnam_r(
-    const char *nam, struct group *grp, char *buf, size_t bufsiz,
-    struct group **res) {
-#if GETGRNAM_R_NETBSD
-	int error;
-	errno = 0;
-	return (error = getgrnam_r(nam, grp, buf, bufsiz, res))? error : errno;
-#else
-	return getgrnam_r(nam, grp, buf, bufsiz, res);
+JANET_FN(cfun_shm_open, SYS_FUSAGE("shm-open", " name size & flags"),
+         "-> _:sys/shm|throws error_\n\n"
+         "\t`name`  **:string** _such as \"/my-cache\"_\n\n"
+         "\t`size`  **:number|nil** _bytes, nil to keep the current size_\n\n"
+         "\t`flags` **:keyword** _optional, any of :create :excl "
+         ":truncate_\n\n"
+         "Opens (creating it with :create) the named POSIX shared memory "
+         "object `name`, which any process may open by name until it's "
+         "removed with `shm-unlink`, and maps it read-write sized to `size` "
+         "bytes. Objects are created with mode 0600.") {
+    janet_arity(argc, 2, 6);
+
+    const char *name = janet_getcstring(argv, 0);
+    int64_t size = janet_checktype(argv[1], JANET_NIL)
+        ? -1 : janet_getinteger64(argv, 1);
+    int flags = O_RDWR;
+    int fd;
+
+    if (size < -1)
+        janet_panic("Slot #2 must be a size of at least 0");
+
+    for (int32_t i = 2; i < argc; i++) {
+        if (janet_keyeq(argv[i], "create"))
+            flags |= O_CREAT;
+        else if (janet_keyeq(argv[i], "excl"))
+            flags |= O_EXCL;
+        else if (janet_keyeq(argv[i], "truncate"))
+            flags |= O_TRUNC;
+        else
+            janet_panicf("Slot #%d must be a keyword equal to :create "
+                         "| :excl | :truncate", i + 1);
+    }
+
+    if (-1 == (fd = shm_open(name, flags, 0600))) {
+        sys_errnof("Failed to open shared memory: %s", name);
+        return janet_wrap_boolean(0);
+    }
+
+    return sys_shm_new(fd, size);
+}
+
+JANET_FN(cfun_shm_unlink, SYS_FUSAGE("shm-unlink", " name"),
+         "-> _true|throws error_\n\n"
+         "\t`name` **:string**\n\n"
+         "Removes the name of POSIX shared memory object `name`. The memory "
+         "itself lives on until every mapping and descriptor of it is "
+         "gone.") {
+    janet_fixarity(argc, 1);
+
+    const char *name = janet_getcstring(argv, 0);
+
+    if (0 != shm_unlink(name)) {
+        sys_errnof("Failed to unlink shared memory: %s", name);
+        return janet_wrap_boolean(0);
+    }
+
+    return janet_wrap_boolean(1);
+}
+
+JANET_FN(cfun_shm_map, SYS_FUSAGE("shm-map", " fd"),
+         "-> _:sys/shm|throws error_\n\n"
+         "\t`fd` **:number|:core/file|:core/stream**\n\n"
+         "Maps the whole of an existing shared memory descriptor, such as "
+         "one received from another process, read-write. The descriptor is "
+         "duplicated, so `fd` stays the caller's to close.") {
+    janet_fixarity(argc, 1);
+
+    int fd = janet_checktype(argv[0], JANET_NUMBER)
+        ? janet_getinteger(argv, 0) : sys_getfd(argv, 0);
+    int dup;
+
+    if (-1 == (dup = fcntl(fd, F_DUPFD_CLOEXEC, 0))) {
+        sys_errnof("Failed to duplicate descriptor: %d", fd);
+        return janet_wrap_boolean(0);
+    }
+
+    return sys_shm_new(dup, -1);
+}
+
+JANET_FN(cfun_shm_resize, SYS_FUSAGE("shm-resize", " shm size"),
+         "-> _:sys/shm|throws error_\n\n"
+         "\t`shm`  **:sys/shm**\n\n"
+         "\t`size` **:number** _bytes_\n\n"
+         "Grows or shrinks `shm` to `size` bytes and remaps it. The mapping "
+         "may move, so views taken with `shm-view` before resizing stop "
+         "working and must be taken again. Other processes sharing the "
+         "object see the new size only once they remap it themselves.") {
+    janet_fixarity(argc, 2);
+
+    SysShm *shm = sys_getshm(argv, 0);
+    int64_t size = janet_getinteger64(argv, 1);
+    uint8_t *map;
+    int err;
+
+    if (size < 0)
+        janet_panic("Slot #2 must be a size of at least 0");
+
+    if (0 != ftruncate(shm->fd, (off_t) size)) {
+        sys_errno("Failed to resize shared memory");
+        return janet_wrap_boolean(0);
+    }
+
+    if ((size_t) size == shm->size)
+        return argv[0];
+
+#ifdef MREMAP_MAYMOVE
+    if (shm->map && size) {
+        map = mremap(shm->map, shm->size, (size_t) size, MREMAP_MAYMOVE);
+
+        if (MAP_FAILED == map) {
+            /* the old mapping is intact, put the old size back to match */
+            err = errno;
+            (void) ftruncate(shm->fd, (off_t) shm->size);
+            errno = err;
+            sys_errno("Failed to remap shared memory");
+            return janet_wrap_boolean(0);
+        }
+    } else
 #endif
+    {
+        if (shm->map)
+            munmap(shm->map, shm->size);
+        shm->map = NULL;
+        map = size ? sys_shm_mmap(shm->fd, (size_t) size, shm->writable)
+                   : NULL;
+
+        if (MAP_FAILED == map) {
+            /* the old mapping is gone, leave the object unusable */
+            sys_shm_gc(shm, 0);
+            sys_errno("Failed to remap shared memory");
+            return janet_wrap_boolean(0);
+        }
+    }
+
+    shm->map = map;
+    shm->size = (size_t) size;
+
+    return argv[0];
+}
+
+#ifdef F_ADD_SEALS
+JANET_FN(cfun_shm_seal, SYS_FUSAGE("shm-seal", " shm & seals"),
+         "-> _true|throws error_\n\n"
+         "\t`shm`   **:sys/shm** _from `memfd-create` with "
+         ":allow-sealing_\n\n"
+         "\t`seals` **:keyword** _any of :shrink :grow :write :seal_\n\n"
+         "Permanently forbids the given changes to `shm` for every process "
+         "sharing it, so a receiver can trust its size and contents. :seal "
+         "forbids adding further seals. For :write, `shm` is first remapped "
+         "read-only (views taken before must be taken again), and sealing "
+         "fails while any other writable mapping of it exists, such as one "
+         "in a forked child. Linux only.") {
+    janet_arity(argc, 2, -1);
+
+    SysShm *shm = sys_getshm(argv, 0);
+    int remapped = 0;
+    int seals = 0;
+    int err;
+
+    for (int32_t i = 1; i < argc; i++) {
+        if (janet_keyeq(argv[i], "shrink"))
+            seals |= F_SEAL_SHRINK;
+        else if (janet_keyeq(argv[i], "grow"))
+            seals |= F_SEAL_GROW;
+        else if (janet_keyeq(argv[i], "write"))
+            seals |= F_SEAL_WRITE;
+        else if (janet_keyeq(argv[i], "seal"))
+            seals |= F_SEAL_SEAL;
+        else
+            janet_panicf("Slot #%d must be a keyword equal to :shrink "
+                         "| :grow | :write | :seal", i + 1);
+    }
+
+    /* the kernel won't seal writes while our own mapping allows them */
+    if ((seals & F_SEAL_WRITE) && shm->writable && shm->map) {
+        void *map = sys_shm_mmap(shm->fd, shm->size, 0);
+
+        if (MAP_FAILED == map) {
+            sys_errno("Failed to remap shared memory read-only");
+            return janet_wrap_boolean(0);
+        }
+
+        munmap(shm->map, shm->size);
+        shm->map = map;
+        remapped = 1;
+    }
+    if (seals & F_SEAL_WRITE)
+        shm->writable = 0;
+
+    if (0 != fcntl(shm->fd, F_ADD_SEALS, seals)) {
+        err = errno;
+        shm->writable = sys_shm_writable(shm->fd);
+
+        /* back to a writable mapping, or unusable if that's not possible */
+        if (remapped && shm->writable) {
+            void *map = sys_shm_mmap(shm->fd, shm->size, 1);
+
+            munmap(shm->map, shm->size);
+            shm->map = NULL;
+            if (MAP_FAILED == map)
+                sys_shm_gc(shm, 0);
+            else
+                shm->map = map;
+        }
+
+        errno = err;
+        sys_errno("Failed to seal shared memory");
+        return janet_wrap_boolean(0);
+    }
+
+    return janet_wrap_boolean(1);
+}
+#else /* no sealing */
+DEF_NOT_IMPL(cfun_shm_seal, "sys/shm-seal");
+#endif
+
+/* Checks `offset` and `len` fall within `shm` */
+static void sys_shm_bounds(SysShm *shm, int64_t offset, int64_t len) {
+    if (offset < 0 || len < 0 || (uint64_t) offset > shm->size
+        || (uint64_t) len > shm->size - (uint64_t) offset)
+        janet_panicf("Range %d+%d is outside of the shared memory's %d "
+                     "bytes", (int32_t) offset, (int32_t) len,
+                     (int32_t) shm->size);
+}
+
+/* A window onto part of a shm mapping. It holds on to the shm, and
+ * remembers the mapping it was taken from, so every access can check the
+ * shm is still open and hasn't been resized or remapped since. */
+typedef struct {
+    Janet    shm;
+    int64_t  offset;
+    int32_t  len;
+    uint8_t *base;
+    size_t   size;
+} SysShmView;
+
+static int sys_shm_view_gcmark(void *p, size_t len) {
+    (void) len;
+    janet_mark(((SysShmView *) p)->shm);
+    return 0;
+}
+
+static int sys_shm_view_get(void *p, Janet key, Janet *out);
+static void sys_shm_view_put(void *p, Janet key, Janet value);
+static size_t sys_shm_view_length(void *p, size_t len);
+static JanetByteView sys_shm_view_bytes_view(void *p, size_t len);
+
+static const JanetAbstractType sys_shm_view_type = {
+    "sys/shm-view",
+    NULL,
+    sys_shm_view_gcmark,
+    sys_shm_view_get,
+    sys_shm_view_put,
+    NULL, /* marshal */
+    NULL, /* unmarshal */
+    NULL, /* tostring */
+    NULL, /* compare */
+    NULL, /* hash */
+    NULL, /* next */
+    NULL, /* call */
+    sys_shm_view_length,
+    sys_shm_view_bytes_view,
+    JANET_ATEND_BYTES
+};
+
+/* Returns the first byte of `view`, checking its shm is still mapped the
+ * way it was when the view was taken, and writable when `write` is. */
+static uint8_t *sys_shm_view_bytes(SysShmView *view, int write) {
+    SysShm *shm = janet_unwrap_abstract(view->shm);
+
+    if (-1 == shm->fd)
+        janet_panic("The view's shared memory has been closed");
+    if (shm->map != view->base || shm->size != view->size)
+        janet_panic("The view's shared memory has been resized or "
+                    "remapped, take a new view");
+    if (write && !shm->writable)
+        janet_panic("The view's shared memory is read-only");
+
+    return shm->map + view->offset;
+}
+
+static size_t sys_shm_view_length(void *p, size_t len) {
+    SysShmView *view = (SysShmView *) p;
+    (void) len;
+
+    sys_shm_view_bytes(view, 0);
+
+    return (size_t) view->len;
+}
+
+static JanetByteView sys_shm_view_bytes_view(void *p, size_t len) {
+    SysShmView *view = (SysShmView *) p;
+    JanetByteView out;
+    (void) len;
+
+    out.bytes = sys_shm_view_bytes(view, 0);
+    out.len = view->len;
+
+    return out;
+}
+
+/* Checks `offset` and `len` fall within `view` */
+static void sys_shm_view_bounds(SysShmView *view, int64_t offset,
+                                int64_t len) {
+    if (offset < 0 || len < 0 || offset > view->len
+        || len > view->len - offset)
+        janet_panicf("Range %d+%d is outside of the view's %d bytes",
+                     (int32_t) offset, (int32_t) len, view->len);
+}
+
+static Janet sys_shm_view_read(int32_t argc, Janet *argv) {
+    janet_arity(argc, 3, 4);
+
+    SysShmView *view = janet_getabstract(argv, 0, &sys_shm_view_type);
+    int64_t offset = janet_getinteger64(argv, 1);
+    int32_t len = janet_getnat(argv, 2);
+    JanetBuffer *buf = janet_optbuffer(argv, argc, 3, len);
+    uint8_t *bytes = sys_shm_view_bytes(view, 0);
+
+    sys_shm_view_bounds(view, offset, len);
+    janet_buffer_push_bytes(buf, bytes + offset, len);
+
+    return janet_wrap_buffer(buf);
+}
+
+static Janet sys_shm_view_write(int32_t argc, Janet *argv) {
+    janet_fixarity(argc, 3);
+
+    SysShmView *view = janet_getabstract(argv, 0, &sys_shm_view_type);
+    int64_t offset = janet_getinteger64(argv, 1);
+    JanetByteView src = janet_getbytes(argv, 2);
+    uint8_t *bytes = sys_shm_view_bytes(view, 1);
+
+    sys_shm_view_bounds(view, offset, src.len);
+    memmove(bytes + offset, src.bytes, src.len);
+
+    return argv[0];
+}
+
+static const JanetMethod sys_shm_view_methods[] = {
+    { "read", sys_shm_view_read },
+    { "write", sys_shm_view_write },
+    { NULL, NULL }
+};
+
+static int sys_shm_view_get(void *p, Janet key, Janet *out) {
+    SysShmView *view = (SysShmView *) p;
+
+    if (janet_checkint(key)) {
+        int32_t i = janet_unwrap_integer(key);
+
+        if (i < 0 || i >= view->len)
+            return 0;
+
+        *out = janet_wrap_integer(sys_shm_view_bytes(view, 0)[i]);
+        return 1;
+    }
+
+    if (!janet_checktype(key, JANET_KEYWORD))
+        return 0;
+
+    if (janet_keyeq(key, "length")) {
+        *out = janet_wrap_integer(view->len);
+        return 1;
+    }
+    if (janet_keyeq(key, "offset")) {
+        *out = janet_wrap_number((double) view->offset);
+        return 1;
+    }
+    if (janet_keyeq(key, "shm")) {
+        *out = view->shm;
+        return 1;
+    }
+
+    return janet_getmethod(janet_unwrap_keyword(key), sys_shm_view_methods,
+                           out);
+}
+
+static void sys_shm_view_put(void *p, Janet key, Janet value) {
+    SysShmView *view = (SysShmView *) p;
+
+    if (!janet_checkint(key))
+        janet_panicf("Expected an integer index, got %v", key);
+    if (!janet_checkint(value))
+        janet_panicf("Expected a byte from 0 to 255, got %v", value);
+
+    int32_t i = janet_unwrap_integer(key);
+    int32_t byte = janet_unwrap_integer(value);
+
+    if (i < 0 || i >= view->len)
+        janet_panicf("Index %d is outside of the view's %d bytes", i,
+                     view->len);
+    if (byte < 0 || byte > 255)
+        janet_panicf("Expected a byte from 0 to 255, got %d", byte);
+
+    sys_shm_view_bytes(view, 1)[i] = (uint8_t) byte;
+}
+
+JANET_FN(cfun_shm_view, SYS_FUSAGE("shm-view", " shm &opt offset length"),
+         "-> _:sys/shm-view|throws error_\n\n"
+         "\t`shm`    **:sys/shm**\n\n"
+         "\t`offset` **:number** _optional, defaults to 0_\n\n"
+         "\t`length` **:number** _optional, defaults to the rest_\n\n"
+         "Returns a view onto `length` bytes at `offset` of `shm`, no "
+         "copies made: `(get view i)` and `(put view i byte)` reach the "
+         "shared memory itself, so writes are seen by every process sharing "
+         "`shm` and vice versa. The view has a `length` and can be passed "
+         "wherever bytes are read, such as `string/find`, `buffer/push` or "
+         "`parse`, again without copying. `(:read view offset length &opt "
+         "buf)` and `(:write view offset bytes)` copy ranges out and in, "
+         "relative to the view, and :length, :offset and :shm are its "
+         "extent and owner. The view keeps `shm` alive, and errors once "
+         "`shm` is closed, resized or sealed against writes.") {
+    janet_arity(argc, 1, 3);
+
+    SysShm *shm = sys_getshm(argv, 0);
+    int64_t offset = janet_optinteger64(argv, argc, 1, 0);
+    int64_t len = janet_optinteger64(argv, argc, 2,
+                                     (int64_t) shm->size - offset);
+
+    sys_shm_bounds(shm, offset, len);
+    if (len > INT32_MAX)
+        janet_panic("Views are limited to 2GiB, pass a smaller length");
+
+    SysShmView *view = janet_abstract(&sys_shm_view_type,
+                                      sizeof(SysShmView));
+    view->shm = argv[0];
+    view->offset = offset;
+    view->len = (int32_t) len;
+    view->base = shm->map;
+    view->size = shm->size;
+
+    return janet_wrap_abstract(view);
+}
+
+JANET_FN(cfun_shm_read,
+         SYS_FUSAGE("shm-read", " shm offset length &opt buf"),
+         "-> _:buffer|throws error_\n\n"
+         "\t`shm`    **:sys/shm**\n\n"
+         "\t`offset` **:number**\n\n"
+         "\t`length` **:number**\n\n"
+         "\t`buf`    **:buffer** _optional_\n\n"
+         "Copies `length` bytes at `offset` of `shm` onto the end of `buf`, "
+         "or a new buffer.") {
+    janet_arity(argc, 3, 4);
+
+    SysShm *shm = sys_getshm(argv, 0);
+    int64_t offset = janet_getinteger64(argv, 1);
+    int32_t len = janet_getnat(argv, 2);
+    JanetBuffer *buf = janet_optbuffer(argv, argc, 3, len);
+
+    sys_shm_bounds(shm, offset, len);
+    janet_buffer_push_bytes(buf, shm->map + offset, len);
+
+    return janet_wrap_buffer(buf);
+}
+
+JANET_FN(cfun_shm_write, SYS_FUSAGE("shm-write", " shm offset bytes"),
+         "-> _:sys/shm|throws error_\n\n"
+         "\t`shm`    **:sys/shm**\n\n"
+         "\t`offset` **:number**\n\n"
+         "\t`bytes`  **:string|:buffer**\n\n"
+         "Copies `bytes` into `shm` at `offset`.") {
+    janet_fixarity(argc, 3);
+
+    SysShm *shm = sys_getshm_rw(argv, 0);
+    int64_t offset = janet_getinteger64(argv, 1);
+    JanetByteView bytes = janet_getbytes(argv, 2);
+
+    sys_shm_bounds(shm, offset, bytes.len);
+    memmove(shm->map + offset, bytes.bytes, bytes.len);
+
+    return argv[0];
+}
+
+JANET_FN(cfun_shm_close, SYS_FUSAGE("shm-close", " shm"),
+         "-> _nil_\n\n"
+         "\t`shm` **:sys/shm**\n\n"
+         "Unmaps `shm` and closes its descriptor. Other processes sharing it "
+         "are unaffected. Happens on garbage collection otherwise.") {
+    janet_fixarity(argc, 1);
+
+    sys_shm_gc(janet_getabstract(argv, 0, &sys_shm_type), 0);
+
+    return janet_wrap_nil();
+}
+
+/* Process-shared atomics and rings work on words inside a sys/shm mapping,
+ * so every process sharing it (forked workers included) sees the same
+ * values without any syscalls. */
+#ifdef __GNUC__
+/* Returns the 8 byte aligned word at the offset in slot `n` + 1 of the shm
+ * in slot `n`, which must be writable when `write` is */
+static int64_t *sys_shm_word(const Janet *argv, int32_t n, int write) {
+    SysShm *shm = write ? sys_getshm_rw(argv, n) : sys_getshm(argv, n);
+    int64_t offset = janet_getinteger64(argv, n + 1);
+
+    if (offset % 8)
+        janet_panicf("Slot #%d must be a multiple of 8", n + 2);
+    sys_shm_bounds(shm, offset, 8);
+
+    return (int64_t *) (shm->map + offset);
+}
+
+JANET_FN(cfun_atomic_load, SYS_FUSAGE("atomic-load", " shm offset"),
+         "-> _:number|throws error_\n\n"
+         "\t`shm`    **:sys/shm**\n\n"
+         "\t`offset` **:number** _a multiple of 8_\n\n"
+         "Atomically reads the 64-bit integer at `offset` of `shm`. Values "
+         "beyond 2^53 lose precision once returned.") {
+    janet_fixarity(argc, 2);
+
+    int64_t *word = sys_shm_word(argv, 0, 0);
+
+    return janet_wrap_number(
+        (double) __atomic_load_n(word, __ATOMIC_ACQUIRE));
 }
 
-static int sys_getgrid(
-    gid_t gid, struct group **ent, char *buf, size_t len) {
-    int err;
-    struct group tmp;
+JANET_FN(cfun_atomic_store,
+         SYS_FUSAGE("atomic-store", " shm offset value"),
+         "-> _:sys/shm|throws error_\n\n"
+         "\t`shm`    **:sys/shm**\n\n"
+         "\t`offset` **:number** _a multiple of 8_\n\n"
+         "\t`value`  **:number**\n\n"
+         "Atomically sets the 64-bit integer at `offset` of `shm` to "
+         "`value`.") {
+    janet_fixarity(argc, 3);
 
-    while ((err = u_getgrgid_r(gid, &tmp, buf, len, ent))) {
-        if (err != ERANGE)
-            return err;
-        if (janet_srealloc(buf, sizeof(char) * (len + 128)))
-            return err;
+    int64_t *word = sys_shm_word(argv, 0, 1);
+    int64_t value = janet_getinteger64(argv, 2);
 
-        len += 128;
-        /* TODO: Limit to a reasonable maximal bound */
-        *ent = NULL;
-    }
+    __atomic_store_n(word, value, __ATOMIC_RELEASE);
 
-    return 0;
+    return argv[0];
 }
 
-static int sys_getgrnam(
-    const char *name, struct group **ent, char *buf, size_t len) {
-    int err;
-    struct group tmp;
+JANET_FN(cfun_atomic_add, SYS_FUSAGE("atomic-add", " shm offset delta"),
+         "-> _:number|throws error_\n\n"
+         "\t`shm`    **:sys/shm**\n\n"
+         "\t`offset` **:number** _a multiple of 8_\n\n"
+         "\t`delta`  **:number** _may be negative_\n\n"
+         "Atomically adds `delta` to the 64-bit integer at `offset` of "
+         "`shm`, returning the value it held before.") {
+    janet_fixarity(argc, 3);
 
-    while ((err = u_getgrnam_r(name, &tmp, buf, len, ent))) {
-        if (err != ERANGE)
-            return err;
-        if (janet_srealloc(buf, sizeof(char) * (len + 128)))
-            return err;
+    int64_t *word = sys_shm_word(argv, 0, 1);
+    int64_t delta = janet_getinteger64(argv, 2);
 
-        len += 128;
-        /* TODO: Limit to a reasonable maximal bound */
-        *ent = NULL;
-    }
+    return janet_wrap_number(
+        (double) __atomic_fetch_add(word, delta, __ATOMIC_ACQ_REL));
+}
+
+JANET_FN(cfun_atomic_cas,
+         SYS_FUSAGE("atomic-cas", " shm offset expected desired"),
+         "-> _:boolean|throws error_\n\n"
+         "\t`shm`      **:sys/shm**\n\n"
+         "\t`offset`   **:number** _a multiple of 8_\n\n"
+         "\t`expected` **:number**\n\n"
+         "\t`desired`  **:number**\n\n"
+         "Atomically sets the 64-bit integer at `offset` of `shm` to "
+         "`desired` if it still holds `expected`. Returns whether it "
+         "did.") {
+    janet_fixarity(argc, 4);
+
+    int64_t *word = sys_shm_word(argv, 0, 1);
+    int64_t expected = janet_getinteger64(argv, 2);
+    int64_t desired = janet_getinteger64(argv, 3);
+
+    return janet_wrap_boolean(__atomic_compare_exchange_n(
+        word, &expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+}
+#else /* no atomic builtins */
+DEF_NOT_IMPL(cfun_atomic_load, "sys/atomic-load");
+DEF_NOT_IMPL(cfun_atomic_store, "sys/atomic-store");
+DEF_NOT_IMPL(cfun_atomic_add, "sys/atomic-add");
+DEF_NOT_IMPL(cfun_atomic_cas, "sys/atomic-cas");
+#endif
+
+#if defined(__linux__) && defined(__GNUC__) && defined(SYS_futex)
+/* A bounded lock-free queue of byte strings (Vyukov's, so any number of
+ * producers and consumers may share it) laid out inside a shm mapping:
+ * this header, each counter on its own cache line, followed by `capacity`
+ * slots. Blocked pushes and pops sleep on the `pushed`/`popped` futex
+ * words, which are only woken when the matching waiter count says someone
+ * is asleep, so uncontended operations never enter the kernel. */
+#define SYS_RING_MAGIC UINT64_C(0x6a7379732d72696e) /* "jsys-rin" */
+#define SYS_RING_MAX   (UINT32_C(1) << 30)
+
+typedef struct {
+    uint64_t magic;
+    uint32_t capacity;     /* slots, a power of two */
+    uint32_t slot_size;    /* most payload bytes per slot */
+    uint8_t  pad0[48];
+    uint64_t head;         /* next position to push */
+    uint32_t pushed;       /* futex, bumped after every push */
+    uint32_t pop_waiters;
+    uint8_t  pad1[48];
+    uint64_t tail;         /* next position to pop */
+    uint32_t popped;       /* futex, bumped after every pop */
+    uint32_t push_waiters;
+    uint8_t  pad2[48];
+} SysRingHeader;
+
+typedef struct {
+    uint64_t seq;
+    uint32_t len;
+    uint32_t pad;
+    uint8_t  data[];
+} SysRingSlot;
+
+/* Capacity and slot size are kept out of the mapping, so a peer
+ * scribbling over the header can't send us out of bounds. */
+typedef struct {
+    Janet    shm;
+    int64_t  offset;
+    uint32_t capacity;
+    uint32_t slot_size;
+} SysRing;
+
+static uint64_t sys_ring_stride(uint32_t slot_size) {
+    return sizeof(SysRingSlot) + (((uint64_t) slot_size + 7) & ~7ULL);
+}
 
+static uint64_t sys_ring_bytes(uint32_t capacity, uint32_t slot_size) {
+    return sizeof(SysRingHeader) + capacity * sys_ring_stride(slot_size);
+}
+
+static int sys_ring_gcmark(void *p, size_t len) {
+    (void) len;
+    janet_mark(((SysRing *) p)->shm);
     return 0;
 }
 
-int sys_name_opt(Janet *argv) {
-    return janet_checktype(argv[0], JANET_NUMBER) ? 1 : 0;
+static int sys_ring_get(void *p, Janet key, Janet *out);
+
+static const JanetAbstractType sys_ring_type = {
+    "sys/ring",
+    NULL,
+    sys_ring_gcmark,
+    sys_ring_get,
+    JANET_ATEND_GET
+};
+
+static const JanetMethod sys_ring_methods[] = {
+    { "push", cfun_ring_push },
+    { "pop", cfun_ring_pop },
+    { NULL, NULL }
+};
+
+/* Returns the header of `ring`, checking its shm is still open and large
+ * enough to hold it. */
+static SysRingHeader *sys_ring_header(SysRing *ring) {
+    SysShm *shm = janet_unwrap_abstract(ring->shm);
+
+    if (-1 == shm->fd)
+        janet_panic("The ring's shared memory has been closed");
+    if (!shm->writable)
+        janet_panic("The ring's shared memory has been sealed against "
+                    "writes");
+    sys_shm_bounds(shm, ring->offset,
+                   sys_ring_bytes(ring->capacity, ring->slot_size));
+
+    return (SysRingHeader *) (shm->map + ring->offset);
 }
 
-/* TODO: maybe a nicer doc string? */
-JANET_FN(cfun_getpwnam, SYS_FUSAGE0("getpwnam id-or-username"),
-         "-> _:struct user-details|throws error\n\n"
-         "\t`id-or-username` **:number|:string**\n\n"
-         "\t**user-details** {:user-name `:string` :password `:string` "
-         ":user-id `:number` :group-id `:number` :home-directory `:string` "
-         ":shell `:string` :gecos `:string`}\n\n"
-         "Gets the details on a username specified by id or by username with "
-         "`id-or-username`.") {
-    janet_fixarity(argc, 1);
+static SysRingSlot *sys_ring_slot(SysRing *ring, SysRingHeader *hdr,
+                                  uint64_t pos) {
+    return (SysRingSlot *) ((uint8_t *) (hdr + 1)
+                            + (pos & (ring->capacity - 1))
+                            * sys_ring_stride(ring->slot_size));
+}
 
-    struct passwd *ent;
-    char  *buf = (char *)janet_smalloc(sizeof(char) * 128);
+static int sys_ring_get(void *p, Janet key, Janet *out) {
+    SysRing *ring = (SysRing *) p;
 
-    /* did we get an ID? or a Name? */
-    switch(sys_name_opt(argv)) {
-        case 1: /* is int */
-            if(0 != sys_getpwuid(janet_getinteger(argv, 0), &ent, buf, 128)) {
-                sys_errnof("No entry for uid: %d", janet_getinteger(argv, 0));
-                return janet_wrap_boolean(0);
-            }
-            break;
-        case 0: /* is string */
-            if(0 != sys_getpwnam(janet_getcstring(argv, 0), &ent, buf, 128)) {
-                sys_errnof("No entry for username: %s",
-                           janet_getcstring(argv, 0));
-                return janet_wrap_boolean(0);
-            }
-            break;
+    if (!janet_checktype(key, JANET_KEYWORD))
+        return 0;
+
+    if (janet_keyeq(key, "capacity")) {
+        *out = janet_wrap_number(ring->capacity);
+        return 1;
+    }
+    if (janet_keyeq(key, "slot-size")) {
+        *out = janet_wrap_number(ring->slot_size);
+        return 1;
+    }
+    if (janet_keyeq(key, "shm")) {
+        *out = ring->shm;
+        return 1;
+    }
+    if (janet_keyeq(key, "count")) {
+        SysRingHeader *hdr = sys_ring_header(ring);
+        uint64_t tail = __atomic_load_n(&hdr->tail, __ATOMIC_ACQUIRE);
+        uint64_t head = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+        uint64_t count = head > tail ? head - tail : 0;
+
+        *out = janet_wrap_number(
+            (double) (count > ring->capacity ? ring->capacity : count));
+        return 1;
     }
 
-    /* extract info */
-    /* TODO: support the time_t fields? */
-    JanetKV *ret = janet_struct_begin(7);
-    janet_struct_put(ret,
-                     janet_ckeywordv("user-name"),
-                     janet_wrap_string(janet_cstring(ent->pw_name)));
-    janet_struct_put(ret,
-                     janet_ckeywordv("password"),
-                     janet_wrap_string(janet_cstring(ent->pw_passwd)));
-    janet_struct_put(ret,
-                     janet_ckeywordv("user-id"),
-                     janet_wrap_integer(ent->pw_uid));
-    janet_struct_put(ret,
-                     janet_ckeywordv("group-id"),
-                     janet_wrap_integer(ent->pw_gid));
-    janet_struct_put(ret,
-                     janet_ckeywordv("home-directory"),
-                     janet_wrap_string(janet_cstring(ent->pw_dir)));
-    janet_struct_put(ret,
-                     janet_ckeywordv("shell"),
-                     janet_wrap_string(janet_cstring(ent->pw_shell)));
-    janet_struct_put(ret,
-                     janet_ckeywordv("gecos"),
-                     janet_wrap_string(janet_cstring(ent->pw_gecos)));
+    return janet_getmethod(janet_unwrap_keyword(key), sys_ring_methods, out);
+}
 
-    /* copy out above! */
-    janet_sfree(buf);
+static Janet sys_ring_new(const Janet *argv, int64_t offset,
+                          uint32_t capacity, uint32_t slot_size) {
+    SysRing *ring = janet_abstract(&sys_ring_type, sizeof(SysRing));
 
-    return janet_wrap_struct(janet_struct_end(ret));
+    ring->shm = argv[0];
+    ring->offset = offset;
+    ring->capacity = capacity;
+    ring->slot_size = slot_size;
+
+    return janet_wrap_abstract(ring);
 }
 
-/* *nix: grp.h, *: ? */
-JANET_FN(cfun_getgrnam, SYS_FUSAGE("getgrnam", " id-or-groupname"),
-         "-> _:struct group-details|thows error_\n\n"
-         "\t`id-or-groupname` **:number|:string**\n\n"
-         "\t**user-details** {:group-name `:string` :password `:string` "
-         ":group-id `:number`}\n\n"
-         "Gets the details on a group specified by id or by group name with "
-         "`id-or-username`") {
-    janet_fixarity(argc, 1);
+static uint32_t sys_ring_getsize(const Janet *argv, int32_t n,
+                                 const char *what) {
+    int64_t size = janet_getinteger64(argv, n);
 
-    struct group *ent;
-    char  *buf = (char *)janet_smalloc(sizeof(char) * 128);
+    if (size < 1 || size > SYS_RING_MAX)
+        janet_panicf("Slot #%d must be a %s from 1 to 2^30", n + 1, what);
 
-    /* did we get an ID? or a Name? */
-    switch(sys_name_opt(argv)) {
-        case 1: /* is int */
-            if(0 != sys_getgrid(janet_getinteger(argv, 0), &ent, buf, 128)) {
-                sys_errnof("No entry for uid: %d", janet_getinteger(argv, 0));
-                return janet_wrap_boolean(0);
+    return (uint32_t) size;
+}
+
+static void sys_ring_wake(uint32_t *word, uint32_t *waiters) {
+    __atomic_fetch_add(word, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(waiters, __ATOMIC_SEQ_CST))
+        syscall(SYS_futex, word, FUTEX_WAKE, INT32_MAX, NULL, NULL, 0);
+}
+
+static int sys_ring_try_push(SysRing *ring, SysRingHeader *hdr,
+                             const uint8_t *bytes, uint32_t len) {
+    uint64_t pos = __atomic_load_n(&hdr->head, __ATOMIC_RELAXED);
+
+    for (;;) {
+        SysRingSlot *slot = sys_ring_slot(ring, hdr, pos);
+        uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        int64_t dif = (int64_t) (seq - pos);
+
+        if (0 == dif) {
+            if (__atomic_compare_exchange_n(&hdr->head, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED)) {
+                slot->len = len;
+                memcpy(slot->data, bytes, len);
+                __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+                sys_ring_wake(&hdr->pushed, &hdr->pop_waiters);
+                return 1;
             }
-            break;
-        case 0: /* is string */
-            if(0 != sys_getgrnam(janet_getcstring(argv, 0), &ent, buf, 128)) {
-                sys_errnof("No entry for username: %s",
-                           janet_getcstring(argv, 0));
-                return janet_wrap_boolean(0);
+        } else if (dif < 0) {
+            return 0; /* full */
+        } else {
+            pos = __atomic_load_n(&hdr->head, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/* `buf` must already have room for a whole slot, nothing may panic
+ * between claiming a slot and releasing it. */
+static int sys_ring_try_pop(SysRing *ring, SysRingHeader *hdr,
+                            JanetBuffer *buf) {
+    uint64_t pos = __atomic_load_n(&hdr->tail, __ATOMIC_RELAXED);
+
+    for (;;) {
+        SysRingSlot *slot = sys_ring_slot(ring, hdr, pos);
+        uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        int64_t dif = (int64_t) (seq - (pos + 1));
+
+        if (0 == dif) {
+            if (__atomic_compare_exchange_n(&hdr->tail, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED)) {
+                uint32_t len = slot->len < ring->slot_size
+                    ? slot->len : ring->slot_size;
+
+                memcpy(buf->data + buf->count, slot->data, len);
+                buf->count += (int32_t) len;
+                __atomic_store_n(&slot->seq, pos + ring->capacity,
+                                 __ATOMIC_RELEASE);
+                sys_ring_wake(&hdr->popped, &hdr->push_waiters);
+                return 1;
             }
-            break;
+        } else if (dif < 0) {
+            return 0; /* empty */
+        } else {
+            pos = __atomic_load_n(&hdr->tail, __ATOMIC_RELAXED);
+        }
     }
+}
 
-    /* extract info */
-    /* TODO: support the time_t fields? */
-    JanetKV *ret = janet_struct_begin(4);
-    janet_struct_put(ret,
-                     janet_ckeywordv("group-name"),
-                     janet_wrap_string(janet_cstring(ent->gr_name)));
-    janet_struct_put(ret,
-                     janet_ckeywordv("password"),
-                     janet_wrap_string(janet_cstring(ent->gr_passwd)));
-    janet_struct_put(ret,
-                     janet_ckeywordv("group-id"),
-                     janet_wrap_integer(ent->gr_gid));
+/* Sleeps on `word` unless it has moved on from `seen`, for at most until
+ * `deadline` when it isn't NULL. Returns 0 once `deadline` has passed. */
+static int sys_ring_sleep(uint32_t *word, uint32_t seen,
+                          const struct timespec *deadline) {
+    struct timespec now, rel;
 
-    /* handle members as tuple */
-    int len = 0;
-    for(; ent->gr_mem[len]; len++)
-        ;;
+    if (NULL == deadline) {
+        syscall(SYS_futex, word, FUTEX_WAIT, seen, NULL, NULL, 0);
+        return 1;
+    }
 
-    Janet *mem = janet_malloc(sizeof(Janet) * len);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    rel.tv_sec = deadline->tv_sec - now.tv_sec;
+    rel.tv_nsec = deadline->tv_nsec - now.tv_nsec;
+    if (rel.tv_nsec < 0) {
+        rel.tv_sec--;
+        rel.tv_nsec += 1000000000L;
+    }
+    if (rel.tv_sec < 0)
+        return 0;
 
-    for(int i = 0; ent->gr_mem[i]; i++) {
-       mem[i] = janet_wrap_string(janet_cstring(ent->gr_mem[i]));
+    syscall(SYS_futex, word, FUTEX_WAIT, seen, &rel, NULL, 0);
+    return 1;
+}
+
+/* Reads an optional timeout in seconds from slot `n` into `deadline`,
+ * returning `deadline`, or NULL to wait forever. A `wait` of 0 is left to
+ * the caller as "don't wait". */
+static struct timespec *sys_ring_deadline(const Janet *argv, int32_t argc,
+                                          int32_t n, double *wait,
+                                          struct timespec *deadline) {
+    if (n >= argc || janet_checktype(argv[n], JANET_NIL)) {
+        *wait = -1;
+        return NULL;
     }
 
-    janet_struct_put(ret,
-                    janet_ckeywordv("group-members"),
-                    janet_wrap_tuple(janet_tuple_n(mem, len)));
+    *wait = janet_getnumber(argv, n);
+    if (*wait < 0)
+        janet_panicf("Slot #%d must be a timeout of at least 0", n + 1);
 
-    const JanetStruct r = janet_struct_end(ret);
+    clock_gettime(CLOCK_MONOTONIC, deadline);
+    deadline->tv_sec += (time_t) *wait;
+    deadline->tv_nsec += (long) ((*wait - (double) (time_t) *wait) * 1e9);
+    if (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
 
-    /* copy out above! */
-    janet_sfree(buf);
+    return deadline;
+}
 
-    return janet_wrap_struct(r);
+JANET_FN(cfun_ring_bytes, SYS_FUSAGE("ring-bytes", " capacity slot-size"),
+         "-> _:number|throws error_\n\n"
+         "\t`capacity`  **:number** _slots, a power of two_\n\n"
+         "\t`slot-size` **:number** _most bytes per message_\n\n"
+         "Returns how many bytes of shared memory a ring of `capacity` "
+         "messages of up to `slot-size` bytes needs.") {
+    janet_fixarity(argc, 2);
+
+    uint32_t capacity = sys_ring_getsize(argv, 0, "capacity");
+    uint32_t slot_size = sys_ring_getsize(argv, 1, "slot size");
+
+    return janet_wrap_number((double) sys_ring_bytes(capacity, slot_size));
 }
 
-/* nix: stdio.h, *: ?*/
-int file_to_fd(Janet *argv, int idx) {
-    if(janet_checkfile(argv[idx]))
-        return fileno(janet_unwrapfile(argv[idx], NULL));
-    return -1;
+JANET_FN(cfun_ring_init,
+         SYS_FUSAGE("ring-init", " shm offset capacity slot-size"),
+         "-> _:sys/ring|throws error_\n\n"
+         "\t`shm`       **:sys/shm**\n\n"
+         "\t`offset`    **:number** _a multiple of 64_\n\n"
+         "\t`capacity`  **:number** _slots, a power of two_\n\n"
+         "\t`slot-size` **:number** _most bytes per message_\n\n"
+         "Lays out an empty ring at `offset` of `shm`, which must have "
+         "`(ring-bytes capacity slot-size)` bytes there, and returns it. "
+         "Any number of processes may push and pop concurrently: rings "
+         "made before `fork` are shared with the children, others can "
+         "attach with `ring-open`. Only initialize a ring while nothing "
+         "else is using it. Linux only.") {
+    janet_fixarity(argc, 4);
+
+    SysShm *shm = sys_getshm_rw(argv, 0);
+    int64_t offset = janet_getinteger64(argv, 1);
+    uint32_t capacity = sys_ring_getsize(argv, 2, "capacity");
+    uint32_t slot_size = sys_ring_getsize(argv, 3, "slot size");
+
+    if (offset % 64)
+        janet_panic("Slot #2 must be a multiple of 64");
+    if (capacity & (capacity - 1))
+        janet_panic("Slot #3 must be a power of two");
+    sys_shm_bounds(shm, offset, sys_ring_bytes(capacity, slot_size));
+
+    Janet out = sys_ring_new(argv, offset, capacity, slot_size);
+    SysRing *ring = janet_unwrap_abstract(out);
+    SysRingHeader *hdr = (SysRingHeader *) (shm->map + offset);
+
+    memset(hdr, 0, sizeof(SysRingHeader));
+    hdr->capacity = capacity;
+    hdr->slot_size = slot_size;
+    for (uint64_t i = 0; i < capacity; i++)
+        sys_ring_slot(ring, hdr, i)->seq = i;
+    __atomic_store_n(&hdr->magic, SYS_RING_MAGIC, __ATOMIC_RELEASE);
+
+    return out;
 }
 
-JANET_FN(cfun_fileno, SYS_FUSAGE("fileno", " file"),
-         "-> _:number|throws error_\n\n"
-         "\t`file` **:core/file**\n\n"
-         "Returns the integer file descriptor from a :core/file.") {
-    int ret;
-    if (-1 != (ret = file_to_fd(argv , 0)))
-        return janet_wrap_integer(ret);
+JANET_FN(cfun_ring_open, SYS_FUSAGE("ring-open", " shm offset"),
+         "-> _:sys/ring|throws error_\n\n"
+         "\t`shm`    **:sys/shm**\n\n"
+         "\t`offset` **:number**\n\n"
+         "Attaches to a ring another process made with `ring-init` at "
+         "`offset` of `shm`. Linux only.") {
+    janet_fixarity(argc, 2);
+
+    SysShm *shm = sys_getshm_rw(argv, 0);
+    int64_t offset = janet_getinteger64(argv, 1);
+    SysRingHeader *hdr;
+
+    if (offset % 64)
+        janet_panic("Slot #2 must be a multiple of 64");
+    sys_shm_bounds(shm, offset, sizeof(SysRingHeader));
+
+    hdr = (SysRingHeader *) (shm->map + offset);
+    if (SYS_RING_MAGIC != __atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE))
+        janet_panicf("No ring at offset %d of the shared memory",
+                     (int32_t) offset);
+    if (!hdr->capacity || hdr->capacity > SYS_RING_MAX
+        || (hdr->capacity & (hdr->capacity - 1))
+        || !hdr->slot_size || hdr->slot_size > SYS_RING_MAX)
+        janet_panicf("Ring at offset %d is corrupt", (int32_t) offset);
+    sys_shm_bounds(shm, offset,
+                   sys_ring_bytes(hdr->capacity, hdr->slot_size));
+
+    return sys_ring_new(argv, offset, hdr->capacity, hdr->slot_size);
+}
+
+JANET_FN(cfun_ring_push, SYS_FUSAGE("ring-push", " ring bytes &opt timeout"),
+         "-> _:boolean|throws error_\n\n"
+         "\t`ring`    **:sys/ring**\n\n"
+         "\t`bytes`   **:string|:buffer** _at most the ring's :slot-size_\n\n"
+         "\t`timeout` **:number|nil** _optional seconds, 0 to not wait_\n\n"
+         "Appends `bytes` to `ring`, waiting for room while it's full, "
+         "forever unless `timeout` is given. Returns false if it timed out. "
+         "Waiting blocks the whole thread, event loop included. Linux "
+         "only.") {
+    janet_arity(argc, 2, 3);
+
+    SysRing *ring = janet_getabstract(argv, 0, &sys_ring_type);
+    JanetByteView bytes = janet_getbytes(argv, 1);
+    struct timespec storage, *deadline;
+    double wait;
+    SysRingHeader *hdr;
+
+    if ((uint32_t) bytes.len > ring->slot_size)
+        janet_panicf("Messages are limited to %d bytes by the ring",
+                     (int32_t) ring->slot_size);
+    deadline = sys_ring_deadline(argv, argc, 2, &wait, &storage);
+    hdr = sys_ring_header(ring);
+
+    if (sys_ring_try_push(ring, hdr, bytes.bytes, (uint32_t) bytes.len))
+        return janet_wrap_boolean(1);
+
+    while (0 != wait) {
+        uint32_t seen = __atomic_load_n(&hdr->popped, __ATOMIC_SEQ_CST);
+        int done, slept = 1;
+
+        __atomic_fetch_add(&hdr->push_waiters, 1, __ATOMIC_SEQ_CST);
+        done = sys_ring_try_push(ring, hdr, bytes.bytes,
+                                 (uint32_t) bytes.len);
+        if (!done)
+            slept = sys_ring_sleep(&hdr->popped, seen, deadline);
+        __atomic_fetch_sub(&hdr->push_waiters, 1, __ATOMIC_SEQ_CST);
+
+        if (done || !slept)
+            return janet_wrap_boolean(done);
+    }
 
-    janet_panic("Invalid File Handle");
     return janet_wrap_boolean(0);
 }
 
+JANET_FN(cfun_ring_pop, SYS_FUSAGE("ring-pop", " ring &opt timeout buf"),
+         "-> _:buffer|nil|throws error_\n\n"
+         "\t`ring`    **:sys/ring**\n\n"
+         "\t`timeout` **:number|nil** _optional seconds, 0 to not wait_\n\n"
+         "\t`buf`     **:buffer** _optional_\n\n"
+         "Removes the oldest message from `ring` and appends it to `buf`, "
+         "or a new buffer, waiting for one while the ring is empty, forever "
+         "unless `timeout` is given. Returns nil if it timed out. Waiting "
+         "blocks the whole thread, event loop included. Linux only.") {
+    janet_arity(argc, 1, 3);
+
+    SysRing *ring = janet_getabstract(argv, 0, &sys_ring_type);
+    struct timespec storage, *deadline;
+    double wait;
+    SysRingHeader *hdr;
+    JanetBuffer *buf;
+
+    deadline = sys_ring_deadline(argv, argc, 1, &wait, &storage);
+    buf = janet_optbuffer(argv, argc, 2, 0);
+    janet_buffer_extra(buf, (int32_t) ring->slot_size);
+    hdr = sys_ring_header(ring);
+
+    if (sys_ring_try_pop(ring, hdr, buf))
+        return janet_wrap_buffer(buf);
+
+    while (0 != wait) {
+        uint32_t seen = __atomic_load_n(&hdr->pushed, __ATOMIC_SEQ_CST);
+        int done, slept = 1;
+
+        __atomic_fetch_add(&hdr->pop_waiters, 1, __ATOMIC_SEQ_CST);
+        done = sys_ring_try_pop(ring, hdr, buf);
+        if (!done)
+            slept = sys_ring_sleep(&hdr->pushed, seen, deadline);
+        __atomic_fetch_sub(&hdr->pop_waiters, 1, __ATOMIC_SEQ_CST);
+
+        if (done)
+            return janet_wrap_buffer(buf);
+        if (!slept)
+            break;
+    }
+
+    return janet_wrap_nil();
+}
+#else /* no futexes */
+DEF_NOT_IMPL(cfun_ring_bytes, "sys/ring-bytes");
+DEF_NOT_IMPL(cfun_ring_init, "sys/ring-init");
+DEF_NOT_IMPL(cfun_ring_open, "sys/ring-open");
+DEF_NOT_IMPL(cfun_ring_push, "sys/ring-push");
+DEF_NOT_IMPL(cfun_ring_pop, "sys/ring-pop");
+#endif
+
 static int date_struct_getint(JanetStruct date, char *field) {
     Janet f = janet_struct_get(date, janet_ckeywordv(field));
 
@@ -889,37 +4869,94 @@ void date_struct_to_tm(JanetStruct dt, struct tm *date) {
 
 #else /* Windows */
 /* *nix: unistd.h, *: ? */
-DEF_NOT_IMPL(cfun_chown, "sys/windows/chown");
-DEF_NOT_IMPL(cfun_chroot, "sys/windows/chroot");
-DEF_NOT_IMPL(cfun_dup2, "sys/windows/dup2");
-DEF_NOT_IMPL(cfun_fork, "sys/windows/fork");
-DEF_NOT_IMPL(cfun_setegid, "sys/windows/setegid");
-DEF_NOT_IMPL(cfun_seteuid, "sys/windows/seteuid");
-DEF_NOT_IMPL(cfun_setgid, "sys/windows/setgid");
-DEF_NOT_IMPL(cfun_setuid, "sys/windows/setuid");
-DEF_NOT_IMPL(cfun_setsid, "sys/windows/setsid");
+DEF_NOT_IMPL(cfun_chown, "sys/chown");
+DEF_NOT_IMPL(cfun_chown_tree, "sys/chown-tree");
+DEF_NOT_IMPL(cfun_walk, "sys/walk");
+DEF_NOT_IMPL(cfun_chroot, "sys/chroot");
+DEF_NOT_IMPL(cfun_dup2, "sys/dup2");
+DEF_NOT_IMPL(cfun_fork, "sys/fork");
+DEF_NOT_IMPL(cfun_pidfd_open, "sys/pidfd-open");
+DEF_NOT_IMPL(cfun_pidfd_wait, "sys/pidfd-wait");
+DEF_NOT_IMPL(cfun_pidfd_send_signal, "sys/pidfd-send-signal");
+DEF_NOT_IMPL(cfun_setegid, "sys/setegid");
+DEF_NOT_IMPL(cfun_seteuid, "sys/seteuid");
+DEF_NOT_IMPL(cfun_setgid, "sys/setgid");
+DEF_NOT_IMPL(cfun_setuid, "sys/setuid");
+DEF_NOT_IMPL(cfun_setsid, "sys/setsid");
+DEF_NOT_IMPL(cfun_setfsuid, "sys/setfsuid");
+DEF_NOT_IMPL(cfun_setfsgid, "sys/setfsgid");
+DEF_NOT_IMPL(cfun_setgroups, "sys/setgroups");
+
+/* *nix: sys/resource.h, *: ? */
+DEF_NOT_IMPL(cfun_getrlimit, "sys/getrlimit");
+DEF_NOT_IMPL(cfun_setrlimit, "sys/setrlimit");
+DEF_NOT_IMPL(cfun_prlimit, "sys/prlimit");
+DEF_NOT_IMPL(cfun_raise_rlimit, "sys/raise-rlimit");
 JANET_FN(cfun_getpid, SYS_FUSAGE0("getpid"),
          "-> _:number pid_\n\n"
          "Returns the PID of the current process.") {
     return janet_wrap_integer(GetCurrentProcessId());
 }
-DEF_NOT_IMPL(cfun_getppid, "sys/windows/getppid");
+DEF_NOT_IMPL(cfun_getppid, "sys/getppid");
+
+/* *nix: sys/resource.h, *: ? */
+DEF_NOT_IMPL(cfun_getrusage, "sys/getrusage");
+DEF_NOT_IMPL(cfun_procstat, "sys/procstat");
+
+/* *nix: sched.h sys/resource.h, *: ? */
+DEF_NOT_IMPL(cfun_sched_setaffinity, "sys/sched-setaffinity");
+DEF_NOT_IMPL(cfun_sched_getaffinity, "sys/sched-getaffinity");
+DEF_NOT_IMPL(cfun_sched_setscheduler, "sys/sched-setscheduler");
+DEF_NOT_IMPL(cfun_sched_getscheduler, "sys/sched-getscheduler");
+DEF_NOT_IMPL(cfun_setpriority, "sys/setpriority");
+DEF_NOT_IMPL(cfun_getpriority, "sys/getpriority");
+DEF_NOT_IMPL(cfun_ioprio_set, "sys/ioprio-set");
+DEF_NOT_IMPL(cfun_ioprio_get, "sys/ioprio-get");
+DEF_NOT_IMPL(cfun_cpu_topology, "sys/cpu-topology");
 
 /* *nix: fcntl.h, *: ? */
-DEF_NOT_IMPL(cfun_fcntl, "sys/windows/fcntl");
+DEF_NOT_IMPL(cfun_fcntl, "sys/fcntl");
+DEF_NOT_IMPL(cfun_pipe2, "sys/pipe2");
 
 /* *nix: pwd.h, *: ? */
-DEF_NOT_IMPL(cfun_getpwnam, "sys/windows/getpwnam");
+DEF_NOT_IMPL(cfun_getpwnam, "sys/getpwnam");
 
 /* *nix: grp.h, *: ? */
-DEF_NOT_IMPL(cfun_getgrnam, "sys/windows/getgrnam");
+DEF_NOT_IMPL(cfun_getgrnam, "sys/getgrnam");
 
 /* *nix: stdio.h, *: ? */
-DEF_NOT_IMPL(cfun_fileno, "sys/windows/fileno");
+DEF_NOT_IMPL(cfun_fileno, "sys/fileno");
+
+/* *nix: fcntl.h unistd.h, *: ? */
+DEF_NOT_IMPL(cfun_fallocate, "sys/fallocate");
+DEF_NOT_IMPL(cfun_fadvise, "sys/fadvise");
+DEF_NOT_IMPL(cfun_fdatasync, "sys/fdatasync");
+DEF_NOT_IMPL(cfun_sync_file_range, "sys/sync-file-range");
+
+/* *nix: sys/mman.h, *: ? */
+DEF_NOT_IMPL(cfun_memfd_create, "sys/memfd-create");
+DEF_NOT_IMPL(cfun_shm_open, "sys/shm-open");
+DEF_NOT_IMPL(cfun_shm_unlink, "sys/shm-unlink");
+DEF_NOT_IMPL(cfun_shm_map, "sys/shm-map");
+DEF_NOT_IMPL(cfun_shm_resize, "sys/shm-resize");
+DEF_NOT_IMPL(cfun_shm_seal, "sys/shm-seal");
+DEF_NOT_IMPL(cfun_shm_view, "sys/shm-view");
+DEF_NOT_IMPL(cfun_shm_read, "sys/shm-read");
+DEF_NOT_IMPL(cfun_shm_write, "sys/shm-write");
+DEF_NOT_IMPL(cfun_shm_close, "sys/shm-close");
+DEF_NOT_IMPL(cfun_atomic_load, "sys/atomic-load");
+DEF_NOT_IMPL(cfun_atomic_store, "sys/atomic-store");
+DEF_NOT_IMPL(cfun_atomic_add, "sys/atomic-add");
+DEF_NOT_IMPL(cfun_atomic_cas, "sys/atomic-cas");
+DEF_NOT_IMPL(cfun_ring_bytes, "sys/ring-bytes");
+DEF_NOT_IMPL(cfun_ring_init, "sys/ring-init");
+DEF_NOT_IMPL(cfun_ring_open, "sys/ring-open");
+DEF_NOT_IMPL(cfun_ring_push, "sys/ring-push");
+DEF_NOT_IMPL(cfun_ring_pop, "sys/ring-pop");
 
 /* TODO: Definitely implement this! */
 /* *nix: time.h, *: ? */
-DEF_NOT_IMPL(cfun_strftime, "sys/windows/strftime");
+DEF_NOT_IMPL(cfun_strftime, "sys/strftime");
 #endif
 
 /* *: time.h */
@@ -953,40 +4990,409 @@ JANET_FN(cfun_strftime, SYS_FUSAGE("strftime", "date format"),
     return janet_wrap_string(janet_cstring((char *)datestr->data));
 }
 
+/*============================================================================
+ * Instrumentation
+ ===========================================================================*/
+/* Every cfun registered in JANET_MODULE_ENTRY is swapped for one of the
+ * numbered trampolines below, each owning a slot in `sys_stats`. While
+ * disabled a trampoline is one flag check and an indirect call, while
+ * enabled it times the call and counts it (and any error it throws) with
+ * relaxed atomics so threads sharing the module can all record. */
+typedef struct {
+    const char    *name;
+    JanetCFunction cfun;
+    uint64_t       calls;
+    uint64_t       errors;
+    uint64_t       total_ns;
+    uint64_t       max_ns;
+    uint64_t       buckets[SYS_STATS_BUCKETS];
+} SysStat;
+
+static SysStat sys_stats[SYS_STATS_MAX];
+static int     sys_stats_count = 0;
+static int     sys_stats_enabled = 0;
+
+#ifndef SYS_NO_STATS
+static uint64_t sys_now_ns(void) {
+#ifndef JANET_WINDOWS
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+    LARGE_INTEGER count, freq;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&freq);
+    return (uint64_t) ((double) count.QuadPart * 1e9 / freq.QuadPart);
+#endif
+}
+
+static void sys_stat_record(SysStat *st, uint64_t ns, int error) {
+    uint64_t max = __atomic_load_n(&st->max_ns, __ATOMIC_RELAXED);
+    int bucket = 63 - __builtin_clzll(ns | 1);
+
+    __atomic_fetch_add(&st->calls, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&st->total_ns, ns, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&st->buckets[bucket], 1, __ATOMIC_RELAXED);
+    if (error)
+        __atomic_fetch_add(&st->errors, 1, __ATOMIC_RELAXED);
+
+    while (ns > max && !__atomic_compare_exchange_n(
+               &st->max_ns, &max, ns, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;;
+}
+
+static inline Janet sys_stat_call(int idx, int32_t argc, Janet *argv) {
+    SysStat *st = &sys_stats[idx];
+
+    if (!__atomic_load_n(&sys_stats_enabled, __ATOMIC_RELAXED))
+        return st->cfun(argc, argv);
+
+    JanetTryState  state;
+    JanetSignal    sig;
+    volatile Janet ret = janet_wrap_nil(); /* set between setjmp/longjmp */
+    uint64_t       start = sys_now_ns();
+
+    if (!(sig = janet_try(&state)))
+        ret = st->cfun(argc, argv);
+    janet_restore(&state);
+
+    sys_stat_record(st, sys_now_ns() - start, sig == JANET_SIGNAL_ERROR);
+
+    /* errors and event loop suspensions alike carry on to the caller */
+    if (sig)
+        janet_signalv(sig, state.payload);
+
+    return ret;
+}
+
+#define SYS_STAT_FN(i)                                              \
+    static Janet sys_stat_fn_##i(int32_t argc, Janet *argv) {       \
+        return sys_stat_call(i, argc, argv);                        \
+    }
+#define SYS_STAT_FN10(d)                                                \
+    SYS_STAT_FN(d##0) SYS_STAT_FN(d##1) SYS_STAT_FN(d##2)               \
+    SYS_STAT_FN(d##3) SYS_STAT_FN(d##4) SYS_STAT_FN(d##5)               \
+    SYS_STAT_FN(d##6) SYS_STAT_FN(d##7) SYS_STAT_FN(d##8)               \
+    SYS_STAT_FN(d##9)
+#define SYS_STAT_REF10(d)                                               \
+    sys_stat_fn_##d##0, sys_stat_fn_##d##1, sys_stat_fn_##d##2,         \
+    sys_stat_fn_##d##3, sys_stat_fn_##d##4, sys_stat_fn_##d##5,         \
+    sys_stat_fn_##d##6, sys_stat_fn_##d##7, sys_stat_fn_##d##8,         \
+    sys_stat_fn_##d##9
+
+SYS_STAT_FN10() SYS_STAT_FN10(1) SYS_STAT_FN10(2) SYS_STAT_FN10(3)
+SYS_STAT_FN10(4) SYS_STAT_FN10(5) SYS_STAT_FN10(6) SYS_STAT_FN10(7)
+SYS_STAT_FN10(8) SYS_STAT_FN10(9) SYS_STAT_FN10(10) SYS_STAT_FN10(11)
+SYS_STAT_FN10(12) SYS_STAT_FN10(13) SYS_STAT_FN10(14) SYS_STAT_FN10(15)
+SYS_STAT_FN10(16) SYS_STAT_FN10(17) SYS_STAT_FN10(18) SYS_STAT_FN10(19)
+
+static const JanetCFunction sys_stat_fns[SYS_STATS_MAX] = {
+    SYS_STAT_REF10(), SYS_STAT_REF10(1), SYS_STAT_REF10(2),
+    SYS_STAT_REF10(3), SYS_STAT_REF10(4), SYS_STAT_REF10(5),
+    SYS_STAT_REF10(6), SYS_STAT_REF10(7), SYS_STAT_REF10(8),
+    SYS_STAT_REF10(9), SYS_STAT_REF10(10), SYS_STAT_REF10(11),
+    SYS_STAT_REF10(12), SYS_STAT_REF10(13), SYS_STAT_REF10(14),
+    SYS_STAT_REF10(15), SYS_STAT_REF10(16), SYS_STAT_REF10(17),
+    SYS_STAT_REF10(18), SYS_STAT_REF10(19)
+};
+
+/* Swaps each cfun in `cfuns` for its trampoline, handing out slots on first
+ * sight of a cfun. The module may be loaded by several threads (and more
+ * than once), hence the lock and the lookup of already slotted cfuns. */
+static void sys_stats_wrap(JanetRegExt *cfuns) {
+    static char lock = 0;
+
+    while (__atomic_test_and_set(&lock, __ATOMIC_ACQUIRE))
+        ;;
+
+    for (; cfuns->name; cfuns++) {
+        int i;
+
+        for (i = 0; i < sys_stats_count; i++)
+            if (sys_stats[i].cfun == cfuns->cfun)
+                break;
+
+        if (i == sys_stats_count) {
+            if (i == SYS_STATS_MAX)
+                continue; /* out of slots, leave it uninstrumented */
+            sys_stats[i].name = cfuns->name;
+            sys_stats[i].cfun = cfuns->cfun;
+            __atomic_store_n(&sys_stats_count, i + 1, __ATOMIC_RELEASE);
+        }
+
+        cfuns->cfun = sys_stat_fns[i];
+    }
+
+    __atomic_clear(&lock, __ATOMIC_RELEASE);
+}
+#else /* SYS_NO_STATS */
+static void sys_stats_wrap(JanetRegExt *cfuns) {
+    (void) cfuns;
+}
+#endif
+
+JANET_FN(cfun_stats, SYS_FUSAGE0("stats"),
+         "-> _:table name->call-stats_\n\n"
+         "\t**call-stats** {:calls `:number` :errors `:number` "
+         ":total-ns `:number` :max-ns `:number` :histogram `:array`}\n\n"
+         "Returns a snapshot of the call statistics gathered for each "
+         "function of this module while statistics were enabled with "
+         "`stats-enable`, keyed by function name. Element `i` of "
+         "`:histogram` counts the calls that took between 2^i and 2^(i+1) "
+         "nanoseconds, trailing empty buckets are left out.") {
+    janet_fixarity(argc, 0);
+    (void) argv;
+
+#ifndef SYS_NO_STATS
+    int count = __atomic_load_n(&sys_stats_count, __ATOMIC_ACQUIRE);
+    JanetTable *ret = janet_table(count);
+
+    for (int i = 0; i < count; i++) {
+        SysStat *st = &sys_stats[i];
+        int last = -1;
+
+        JanetArray *hist = janet_array(SYS_STATS_BUCKETS);
+        for (int b = 0; b < SYS_STATS_BUCKETS; b++) {
+            uint64_t n = __atomic_load_n(&st->buckets[b], __ATOMIC_RELAXED);
+            janet_array_push(hist, janet_wrap_number((double) n));
+            if (n)
+                last = b;
+        }
+        janet_array_setcount(hist, last + 1);
+
+        JanetKV *stat = janet_struct_begin(5);
+        janet_struct_put(stat, janet_ckeywordv("calls"),
+                         janet_wrap_number((double) __atomic_load_n(
+                             &st->calls, __ATOMIC_RELAXED)));
+        janet_struct_put(stat, janet_ckeywordv("errors"),
+                         janet_wrap_number((double) __atomic_load_n(
+                             &st->errors, __ATOMIC_RELAXED)));
+        janet_struct_put(stat, janet_ckeywordv("total-ns"),
+                         janet_wrap_number((double) __atomic_load_n(
+                             &st->total_ns, __ATOMIC_RELAXED)));
+        janet_struct_put(stat, janet_ckeywordv("max-ns"),
+                         janet_wrap_number((double) __atomic_load_n(
+                             &st->max_ns, __ATOMIC_RELAXED)));
+        janet_struct_put(stat, janet_ckeywordv("histogram"),
+                         janet_wrap_array(hist));
+
+        janet_table_put(ret, janet_cstringv(st->name),
+                        janet_wrap_struct(janet_struct_end(stat)));
+    }
+
+    return janet_wrap_table(ret);
+#else
+    (void) sys_stats;
+    (void) sys_stats_count;
+    return janet_wrap_table(janet_table(0));
+#endif
+}
+
+JANET_FN(cfun_stats_reset, SYS_FUSAGE0("stats-reset"),
+         "-> _true_\n\n"
+         "Zeroes the call statistics of every function of this module.") {
+    janet_fixarity(argc, 0);
+    (void) argv;
+
+#ifndef SYS_NO_STATS
+    int count = __atomic_load_n(&sys_stats_count, __ATOMIC_ACQUIRE);
+
+    for (int i = 0; i < count; i++) {
+        SysStat *st = &sys_stats[i];
+        __atomic_store_n(&st->calls, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&st->errors, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&st->total_ns, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&st->max_ns, 0, __ATOMIC_RELAXED);
+        for (int b = 0; b < SYS_STATS_BUCKETS; b++)
+            __atomic_store_n(&st->buckets[b], 0, __ATOMIC_RELAXED);
+    }
+#endif
+
+    return janet_wrap_boolean(1);
+}
+
+JANET_FN(cfun_stats_enable, SYS_FUSAGE("stats-enable", " &opt enable"),
+         "-> _:boolean previous|throws error_\n\n"
+         "\t`enable` **:boolean** _optional, defaults to true_\n\n"
+         "Turns gathering of call statistics for the functions of this "
+         "module on or off, returning whether it was on before. Throws an "
+         "error if the module was built with SYS_NO_STATS.") {
+    janet_arity(argc, 0, 1);
+
+#ifndef SYS_NO_STATS
+    int enable = janet_optboolean(argv, argc, 0, 1);
+    return janet_wrap_boolean(
+        __atomic_exchange_n(&sys_stats_enabled, enable, __ATOMIC_RELAXED));
+#else
+    (void) argv;
+    (void) sys_stats_enabled;
+    janet_panic("Call statistics were not compiled into this module");
+    return janet_wrap_boolean(0);
+#endif
+}
+
 /*============================================================================
  * Export functions
  ===========================================================================*/
-/* Don't bother exporting functions for one platform as unimplemented on
- * another platform */
 JANET_MODULE_ENTRY(JanetTable *env) {
-    janet_cfuns_ext(env, "sys", (JanetRegExt[]) {
+    /* Each function is registered under its final name along with any
+     * aliases, all bound directly to the cfun, so sys.janet only needs to
+     * re-export this module. */
+    JanetRegExt cfuns[] = {
         /* *nix: unistd.h, *: ? */
-        JANET_REG(SYS_IMPL "/chown", cfun_chown),
-        JANET_REG(SYS_IMPL "/chroot", cfun_chroot),
-        JANET_REG(SYS_IMPL "/dup2", cfun_dup2),
-        JANET_REG(SYS_IMPL "/fork", cfun_fork),
-        JANET_REG(SYS_IMPL "/setegid", cfun_setegid),
-        JANET_REG(SYS_IMPL "/seteuid", cfun_seteuid),
-        JANET_REG(SYS_IMPL "/setgid", cfun_setgid),
-        JANET_REG(SYS_IMPL "/setuid", cfun_setuid),
-        JANET_REG(SYS_IMPL "/setsid", cfun_setsid),
-        JANET_REG(SYS_IMPL "/getpid", cfun_getpid),
-        JANET_REG(SYS_IMPL "/getppid", cfun_getppid),
+        /* TODO: support chown with username/groupname instead of just
+         *   uid/gid, support optional uid/gid (use keyword args). */
+        JANET_REG("chown", cfun_chown),
+        JANET_REG("change-owner", cfun_chown),
+        JANET_REG("chown-tree", cfun_chown_tree),
+        JANET_REG("change-owner-recursive", cfun_chown_tree),
+        JANET_REG("walk", cfun_walk),
+        JANET_REG("walk-tree", cfun_walk),
+        JANET_REG("chroot", cfun_chroot),
+        JANET_REG("change-root", cfun_chroot),
+        /* TODO: Easier file redirection supporting the :out and :in keywords
+         *   for stdout and stdin; document flags; Make overall nicer/easier.
+         */
+        JANET_REG("dup2", cfun_dup2),
+        JANET_REG("redirect-file", cfun_dup2),
+        /* TODO: may need a different idea on *BSD where kqueue is dead in
+         *   child forks */
+        JANET_REG("fork", cfun_fork),
+        JANET_REG("pidfd-open", cfun_pidfd_open),
+        JANET_REG("pidfd-wait", cfun_pidfd_wait),
+        JANET_REG("wait-child", cfun_pidfd_wait),
+        JANET_REG("pidfd-send-signal", cfun_pidfd_send_signal),
+        JANET_REG("signal-child", cfun_pidfd_send_signal),
+        /* TODO: Allow for setting of the uid/gid by user/group name */
+        JANET_REG("setegid", cfun_setegid),
+        JANET_REG("set-effective-group", cfun_setegid),
+        JANET_REG("seteuid", cfun_seteuid),
+        JANET_REG("set-effective-user", cfun_seteuid),
+        JANET_REG("setgid", cfun_setgid),
+        JANET_REG("set-group", cfun_setgid),
+        JANET_REG("setuid", cfun_setuid),
+        JANET_REG("set-user", cfun_setuid),
+        JANET_REG("setsid", cfun_setsid),
+        JANET_REG("new-session", cfun_setsid),
+        JANET_REG("setfsuid", cfun_setfsuid),
+        JANET_REG("set-filesystem-user", cfun_setfsuid),
+        JANET_REG("setfsgid", cfun_setfsgid),
+        JANET_REG("set-filesystem-group", cfun_setfsgid),
+        JANET_REG("setgroups", cfun_setgroups),
+        JANET_REG("set-thread-groups", cfun_setgroups),
+
+        /* *nix: sys/resource.h, *: ? */
+        JANET_REG("getrlimit", cfun_getrlimit),
+        JANET_REG("get-resource-limit", cfun_getrlimit),
+        JANET_REG("setrlimit", cfun_setrlimit),
+        JANET_REG("set-resource-limit", cfun_setrlimit),
+        JANET_REG("prlimit", cfun_prlimit),
+        JANET_REG("process-resource-limit", cfun_prlimit),
+        JANET_REG("raise-rlimit", cfun_raise_rlimit),
+        JANET_REG("raise-resource-limit", cfun_raise_rlimit),
+
+        JANET_REG("getpid", cfun_getpid),
+        JANET_REG("getppid", cfun_getppid),
+
+        /* *nix: sys/resource.h, /proc (Linux only), *: ? */
+        JANET_REG("getrusage", cfun_getrusage),
+        JANET_REG("resource-usage", cfun_getrusage),
+        JANET_REG("procstat", cfun_procstat),
+        JANET_REG("process-stats", cfun_procstat),
+
+        /* *nix: sched.h sys/resource.h, /sys (Linux only), *: ? */
+        JANET_REG("sched-setaffinity", cfun_sched_setaffinity),
+        JANET_REG("set-cpu-affinity", cfun_sched_setaffinity),
+        JANET_REG("sched-getaffinity", cfun_sched_getaffinity),
+        JANET_REG("get-cpu-affinity", cfun_sched_getaffinity),
+        JANET_REG("sched-setscheduler", cfun_sched_setscheduler),
+        JANET_REG("set-scheduler", cfun_sched_setscheduler),
+        JANET_REG("sched-getscheduler", cfun_sched_getscheduler),
+        JANET_REG("get-scheduler", cfun_sched_getscheduler),
+        JANET_REG("setpriority", cfun_setpriority),
+        JANET_REG("set-nice", cfun_setpriority),
+        JANET_REG("getpriority", cfun_getpriority),
+        JANET_REG("get-nice", cfun_getpriority),
+        JANET_REG("ioprio-set", cfun_ioprio_set),
+        JANET_REG("set-io-priority", cfun_ioprio_set),
+        JANET_REG("ioprio-get", cfun_ioprio_get),
+        JANET_REG("get-io-priority", cfun_ioprio_get),
+        JANET_REG("cpu-topology", cfun_cpu_topology),
 
         /* *nix: fcntl.h, *: ? */
-        JANET_REG(SYS_IMPL "/fcntl", cfun_fcntl),
+        /* TODO: provide a nicer way to use this, right now we're only
+         *   supporting locks but when we support more would be nice to have
+         *   a better interface */
+        JANET_REG("fcntl", cfun_fcntl),
+        JANET_REG("file-settings", cfun_fcntl),
+        JANET_REG("pipe2", cfun_pipe2),
+        JANET_REG("make-pipe", cfun_pipe2),
 
         /* *nix: pwd.h, *: ? */
-        JANET_REG(SYS_IMPL "/getpwnam", cfun_getpwnam),
+        JANET_REG("getpwnam", cfun_getpwnam),
+        JANET_REG("get-user-info", cfun_getpwnam),
 
         /* *nix: grp.h, *: ? */
-        JANET_REG(SYS_IMPL "/getgrnam", cfun_getgrnam),
+        JANET_REG("getgrnam", cfun_getgrnam),
+        JANET_REG("get-group-info", cfun_getgrnam),
 
         /* *nix: stdio.h, *: ? */
-        JANET_REG(SYS_IMPL "/fileno", cfun_fileno),
+        JANET_REG("fileno", cfun_fileno),
+
+        /* *nix: fcntl.h unistd.h, *: ? */
+        JANET_REG("fallocate", cfun_fallocate),
+        JANET_REG("preallocate", cfun_fallocate),
+        JANET_REG("fadvise", cfun_fadvise),
+        JANET_REG("file-advise", cfun_fadvise),
+        JANET_REG("fdatasync", cfun_fdatasync),
+        JANET_REG("sync-data", cfun_fdatasync),
+        JANET_REG("sync-file-range", cfun_sync_file_range),
+        JANET_REG("sync-range", cfun_sync_file_range),
+
+        /* *nix: sys/mman.h, *: ? */
+        JANET_REG("memfd-create", cfun_memfd_create),
+        JANET_REG("shm-open", cfun_shm_open),
+        JANET_REG("shm-unlink", cfun_shm_unlink),
+        JANET_REG("shm-map", cfun_shm_map),
+        JANET_REG("shm-resize", cfun_shm_resize),
+        JANET_REG("shm-seal", cfun_shm_seal),
+        JANET_REG("shm-view", cfun_shm_view),
+        JANET_REG("shm-read", cfun_shm_read),
+        JANET_REG("shm-write", cfun_shm_write),
+        JANET_REG("shm-close", cfun_shm_close),
+
+        /* *nix: GCC atomics, linux/futex.h (rings Linux only), *: ? */
+        JANET_REG("atomic-load", cfun_atomic_load),
+        JANET_REG("atomic-store", cfun_atomic_store),
+        JANET_REG("atomic-add", cfun_atomic_add),
+        JANET_REG("atomic-fetch-add", cfun_atomic_add),
+        JANET_REG("atomic-cas", cfun_atomic_cas),
+        JANET_REG("atomic-compare-and-swap", cfun_atomic_cas),
+        JANET_REG("ring-bytes", cfun_ring_bytes),
+        JANET_REG("ring-init", cfun_ring_init),
+        JANET_REG("make-ring", cfun_ring_init),
+        JANET_REG("ring-open", cfun_ring_open),
+        JANET_REG("open-ring", cfun_ring_open),
+        JANET_REG("ring-push", cfun_ring_push),
+        JANET_REG("ring-pop", cfun_ring_pop),
 
         /* *nix: time.h, *: ? */
-        JANET_REG(SYS_IMPL "/strftime", cfun_strftime),
+        JANET_REG("strftime", cfun_strftime),
+        JANET_REG("date-string", cfun_strftime),
+        JANET_REG_END
+    };
+
+    sys_stats_wrap(cfuns);
+    janet_cfuns_ext(env, "sys", cfuns);
+
+    /* *: instrumentation, not instrumented itself */
+    janet_cfuns_ext(env, "sys", (JanetRegExt[]) {
+        JANET_REG("stats", cfun_stats),
+        JANET_REG("call-stats", cfun_stats),
+        JANET_REG("stats-reset", cfun_stats_reset),
+        JANET_REG("reset-call-stats", cfun_stats_reset),
+        JANET_REG("stats-enable", cfun_stats_enable),
+        JANET_REG("enable-call-stats", cfun_stats_enable),
         JANET_REG_END
     });
 }